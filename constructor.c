@@ -0,0 +1,716 @@
+#include "constructor.h"
+#include "workpool.h"
+#include "wordindex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Backtracking constructor. Two modes share one depth-first search:
+   - free-form: the variables are words, the values are grid placements;
+   - pattern:   the variables are slots, the values are words.
+   Candidates are tried most constrained (fewest options) first, in a
+   seeded order. In pattern mode every crossing slot is forward-checked
+   after a placement so dead branches are cut before recursing. */
+
+typedef struct {
+    size_t word;
+    size_t row, col;
+    Direction dir;
+} Move;
+
+typedef struct {
+    size_t row, col, len;
+    Direction dir;
+} Slot;
+
+/* read-only problem description */
+typedef struct {
+    size_t rows, cols;
+    bool   free_form;
+    const CtorWord *src;
+    size_t nwords;
+    char  (*text)[MAX_WORD_LEN];   /* normalized (uppercase) answers */
+    size_t *len;
+    size_t max_len;
+    WordIndex index;               /* pattern mode: (length, position, letter) bitsets */
+    size_t *bit_of;                /* word id -> bit within its length bucket */
+    Slot   *slots;                 /* pattern mode */
+    size_t  nslots;
+    size_t *cell_slot;             /* rows*cols*2, slot per cell and direction */
+    unsigned long seed;
+} CtorProblem;
+
+/* mutable search state */
+typedef struct {
+    const CtorProblem *p;
+    char   *cells;                 /* '.' open, '#' block, 'A'..'Z' placed */
+    unsigned char *cover;          /* bit per direction covering each cell */
+    bool   *used;                  /* word already on the board */
+    bool   *slot_done;
+    uint64_t *used_bits[MAX_WORD_LEN];  /* pattern mode: used words per length bucket */
+    uint64_t *scratch;             /* pattern mode: query result */
+    Move   *stack;
+    size_t  depth;
+    unsigned long nodes, backtracks, max_nodes;
+    bool    aborted;
+    /* parallel mode: give up once a task earlier than ours has succeeded */
+    _Atomic size_t *winner;
+    size_t  task;
+} CtorState;
+
+#define CELL(p, r, c) ((r) * (p)->cols + (c))
+#define DIR_BIT(d) (1u << (unsigned)(d))
+
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static inline unsigned ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+/* seeded, position-independent ordering key for a move */
+static uint64_t move_key(const CtorProblem *p, const Move *m) {
+    uint64_t h = mix64((uint64_t)p->seed ^ mix64(m->word));
+    h = mix64(h ^ ((uint64_t)m->row << 32) ^ ((uint64_t)m->col << 1) ^ (uint64_t)m->dir);
+    return h;
+}
+
+typedef struct { uint64_t key; Move m; } KeyedMove;
+
+static int keyed_cmp(const void *a, const void *b) {
+    const KeyedMove *x = (const KeyedMove*)a, *y = (const KeyedMove*)b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static void order_moves(const CtorProblem *p, Move *moves, size_t n) {
+    if (n < 2) return;
+    KeyedMove *k = (KeyedMove*)malloc(n * sizeof(KeyedMove));
+    if (!k) return;     /* unordered is still correct */
+    for (size_t i = 0; i < n; ++i) { k[i].m = moves[i]; k[i].key = move_key(p, &moves[i]); }
+    qsort(k, n, sizeof(KeyedMove), keyed_cmp);
+    for (size_t i = 0; i < n; ++i) moves[i] = k[i].m;
+    free(k);
+}
+
+/* ---------------- Problem setup ---------------- */
+
+static bool normalize(const char *in, char out[MAX_WORD_LEN], size_t *len) {
+    size_t n = 0;
+    for (; in[n]; ++n) {
+        if (n >= MAX_WORD_LEN - 1) return false;
+        if (!isalpha((unsigned char)in[n])) return false;
+        out[n] = (char)toupper((unsigned char)in[n]);
+    }
+    out[n] = '\0';
+    *len = n;
+    return n >= 2;
+}
+
+static void problem_free(CtorProblem *p) {
+    free(p->text);
+    free(p->len);
+    wi_free(&p->index);
+    free(p->bit_of);
+    free(p->slots);
+    free(p->cell_slot);
+}
+
+/* collect maximal runs of 2+ open cells and the slot owning each cell */
+static bool find_slots(CtorProblem *p, const char *pattern) {
+    size_t ncells = p->rows * p->cols;
+    p->cell_slot = (size_t*)malloc((ncells ? ncells : 1) * 2 * sizeof(size_t));
+    p->slots = (Slot*)malloc((ncells ? ncells : 1) * sizeof(Slot));
+    if (!p->cell_slot || !p->slots) return false;
+    for (size_t i = 0; i < ncells * 2; ++i) p->cell_slot[i] = CW_NO_WORD;
+
+    for (int d = 0; d < 2; ++d) {
+        Direction dir = (Direction)d;
+        size_t outer = dir == DIR_ACROSS ? p->rows : p->cols;
+        size_t inner = dir == DIR_ACROSS ? p->cols : p->rows;
+        for (size_t a = 0; a < outer; ++a) {
+            size_t b = 0;
+            while (b < inner) {
+                size_t r = dir == DIR_ACROSS ? a : b, c = dir == DIR_ACROSS ? b : a;
+                if (pattern[CELL(p, r, c)] == '#') { ++b; continue; }
+                size_t start = b;
+                while (b < inner) {
+                    size_t rr = dir == DIR_ACROSS ? a : b, cc = dir == DIR_ACROSS ? b : a;
+                    if (pattern[CELL(p, rr, cc)] == '#') break;
+                    ++b;
+                }
+                size_t len = b - start;
+                if (len < 2) continue;
+                Slot *s = &p->slots[p->nslots];
+                s->row = dir == DIR_ACROSS ? a : start;
+                s->col = dir == DIR_ACROSS ? start : a;
+                s->len = len;
+                s->dir = dir;
+                for (size_t k = 0; k < len; ++k) {
+                    size_t rr = s->row + (dir == DIR_DOWN ? k : 0);
+                    size_t cc = s->col + (dir == DIR_ACROSS ? k : 0);
+                    p->cell_slot[CELL(p, rr, cc) * 2 + (size_t)dir] = p->nslots;
+                }
+                ++p->nslots;
+            }
+        }
+    }
+    return true;
+}
+
+/* slots must form one crossing-connected group, or no fill can be connected */
+static bool slots_connected(const CtorProblem *p) {
+    if (p->nslots == 0) return false;
+    size_t *parent = (size_t*)malloc(p->nslots * sizeof(size_t));
+    if (!parent) return false;
+    for (size_t i = 0; i < p->nslots; ++i) parent[i] = i;
+    size_t groups = p->nslots;
+    for (size_t i = 0; i < p->rows * p->cols; ++i) {
+        size_t a = p->cell_slot[i * 2], b = p->cell_slot[i * 2 + 1];
+        if (a == CW_NO_WORD || b == CW_NO_WORD) continue;
+        while (parent[a] != a) a = parent[a] = parent[parent[a]];
+        while (parent[b] != b) b = parent[b] = parent[parent[b]];
+        if (a != b) { parent[a] = b; --groups; }
+    }
+    free(parent);
+    return groups == 1;
+}
+
+static bool problem_init(CtorProblem *p, const CtorWord *words, size_t count,
+                         const CtorOptions *opt)
+{
+    memset(p, 0, sizeof *p);
+    p->rows = opt->rows;
+    p->cols = opt->cols;
+    p->free_form = opt->pattern == NULL;
+    p->seed = opt->seed;
+    p->src = words;
+    p->nwords = count;
+    if (p->rows == 0 || p->cols == 0 || count == 0) return false;
+    if (p->cols > SIZE_MAX / 2 / sizeof(size_t) / p->rows) return false;
+
+    p->text = (char(*)[MAX_WORD_LEN])malloc(count * MAX_WORD_LEN);
+    p->len = (size_t*)malloc(count * sizeof(size_t));
+    if (!p->text || !p->len) return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!words[i].text || !normalize(words[i].text, p->text[i], &p->len[i])) {
+            /* free-form must place every word; a fill dictionary just skips it */
+            if (p->free_form) return false;
+            p->len[i] = 0;
+            continue;
+        }
+        if (p->len[i] > p->max_len) p->max_len = p->len[i];
+    }
+
+    if (!p->free_form) {
+        const char **view = (const char**)malloc(count * sizeof(char*));
+        p->bit_of = (size_t*)malloc(count * sizeof(size_t));
+        if (!view || !p->bit_of) { free(view); return false; }
+        for (size_t i = 0; i < count; ++i) view[i] = p->len[i] ? p->text[i] : NULL;
+        bool ok = wi_build(&p->index, view, count, p->bit_of);
+        free(view);
+        if (!ok) return false;
+        if (!find_slots(p, opt->pattern)) return false;
+        if (!slots_connected(p)) return false;
+    }
+    return true;
+}
+
+/* ---------------- Search state ---------------- */
+
+static void state_free(CtorState *s) {
+    free(s->cells);
+    free(s->cover);
+    free(s->used);
+    free(s->slot_done);
+    for (size_t L = 0; L < MAX_WORD_LEN; ++L) free(s->used_bits[L]);
+    free(s->scratch);
+    free(s->stack);
+}
+
+static bool state_init(CtorState *s, const CtorProblem *p, const char *pattern,
+                       unsigned long max_nodes)
+{
+    memset(s, 0, sizeof *s);
+    s->p = p;
+    s->max_nodes = max_nodes;
+    size_t ncells = p->rows * p->cols;
+    size_t depth_max = p->free_form ? p->nwords : p->nslots;
+    s->cells = (char*)malloc(ncells);
+    s->cover = (unsigned char*)calloc(ncells, 1);
+    s->used = (bool*)calloc(p->nwords, sizeof(bool));
+    s->slot_done = (bool*)calloc(p->nslots ? p->nslots : 1, sizeof(bool));
+    s->stack = (Move*)malloc((depth_max ? depth_max : 1) * sizeof(Move));
+    if (!s->cells || !s->cover || !s->used || !s->slot_done || !s->stack) return false;
+    if (!p->free_form) {
+        size_t widest = 1;
+        for (size_t L = 1; L < MAX_WORD_LEN; ++L) {
+            const WordIndexBucket *b = wi_bucket(&p->index, L);
+            if (!b->nblocks) continue;
+            s->used_bits[L] = (uint64_t*)calloc(b->nblocks, sizeof(uint64_t));
+            if (!s->used_bits[L]) return false;
+            if (b->nblocks > widest) widest = b->nblocks;
+        }
+        s->scratch = (uint64_t*)malloc(widest * sizeof(uint64_t));
+        if (!s->scratch) return false;
+    }
+    for (size_t i = 0; i < ncells; ++i)
+        s->cells[i] = (pattern && pattern[i] == '#') ? '#' : '.';
+    return true;
+}
+
+static bool in_grid(const CtorProblem *p, size_t r, size_t c) {
+    return r < p->rows && c < p->cols;
+}
+
+/* empty or outside the grid */
+static bool is_clear(const CtorState *s, size_t r, size_t c) {
+    return !in_grid(s->p, r, c) || s->cells[CELL(s->p, r, c)] == '.';
+}
+
+static void apply_move(CtorState *s, const Move *m) {
+    const CtorProblem *p = s->p;
+    const char *t = p->text[m->word];
+    for (size_t k = 0; k < p->len[m->word]; ++k) {
+        size_t r = m->row + (m->dir == DIR_DOWN ? k : 0);
+        size_t c = m->col + (m->dir == DIR_ACROSS ? k : 0);
+        s->cells[CELL(p, r, c)] = t[k];
+        s->cover[CELL(p, r, c)] |= (unsigned char)DIR_BIT(m->dir);
+    }
+    s->used[m->word] = true;
+    if (!p->free_form) {
+        s->slot_done[p->cell_slot[CELL(p, m->row, m->col) * 2 + (size_t)m->dir]] = true;
+        size_t bit = p->bit_of[m->word];
+        s->used_bits[p->len[m->word]][bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+    s->stack[s->depth++] = *m;
+}
+
+static void undo_move(CtorState *s) {
+    const CtorProblem *p = s->p;
+    const Move *m = &s->stack[--s->depth];
+    for (size_t k = 0; k < p->len[m->word]; ++k) {
+        size_t r = m->row + (m->dir == DIR_DOWN ? k : 0);
+        size_t c = m->col + (m->dir == DIR_ACROSS ? k : 0);
+        unsigned char *cv = &s->cover[CELL(p, r, c)];
+        *cv &= (unsigned char)~DIR_BIT(m->dir);
+        if (!*cv) s->cells[CELL(p, r, c)] = '.';
+    }
+    s->used[m->word] = false;
+    if (!p->free_form) {
+        s->slot_done[p->cell_slot[CELL(p, m->row, m->col) * 2 + (size_t)m->dir]] = false;
+        size_t bit = p->bit_of[m->word];
+        s->used_bits[p->len[m->word]][bit / 64] &= ~((uint64_t)1 << (bit % 64));
+    }
+}
+
+/* ---------------- Free-form placements ---------------- */
+
+/* Can word w go at (row,col,dir)? Same rules as fits_and_matches, plus the
+   usual crossword spacing: nothing directly before/after the word, no new
+   letter touching a parallel neighbour, at least one crossing.
+   *first_cross receives the index of the first letter that is a crossing. */
+static bool free_fits(const CtorState *s, size_t w, size_t row, size_t col,
+                      Direction dir, size_t *first_cross)
+{
+    const CtorProblem *p = s->p;
+    size_t len = p->len[w];
+    if (!in_grid(p, row, col)) return false;
+    if (dir == DIR_ACROSS ? len > p->cols - col : len > p->rows - row) return false;
+
+    size_t dr = dir == DIR_DOWN, dc = dir == DIR_ACROSS;
+    if (row >= dr && col >= dc && !is_clear(s, row - dr, col - dc)) return false;
+    if (!is_clear(s, row + dr * len, col + dc * len)) return false;
+
+    *first_cross = SIZE_MAX;
+    for (size_t k = 0; k < len; ++k) {
+        size_t r = row + dr * k, c = col + dc * k;
+        char g = s->cells[CELL(p, r, c)];
+        if (g != '.') {
+            if (g != p->text[w][k]) return false;
+            if (s->cover[CELL(p, r, c)] & DIR_BIT(dir)) return false;
+            if (*first_cross == SIZE_MAX) *first_cross = k;
+            continue;
+        }
+        /* new letter: its perpendicular neighbours must be empty */
+        if (dir == DIR_ACROSS) {
+            if (r > 0 && !is_clear(s, r - 1, c)) return false;
+            if (!is_clear(s, r + 1, c)) return false;
+        } else {
+            if (c > 0 && !is_clear(s, r, c - 1)) return false;
+            if (!is_clear(s, r, c + 1)) return false;
+        }
+    }
+    return *first_cross != SIZE_MAX;
+}
+
+/* Enumerate the placements of w that cross the board; each placement is
+   reported once (from its first crossing letter). out may be NULL. */
+static size_t free_placements(const CtorState *s, size_t w, Move *out, size_t limit) {
+    const CtorProblem *p = s->p;
+    size_t n = 0;
+    for (size_t d = 0; d < s->depth; ++d) {
+        const Move *m = &s->stack[d];
+        Direction dir = m->dir == DIR_ACROSS ? DIR_DOWN : DIR_ACROSS;
+        for (size_t i = 0; i < p->len[m->word]; ++i) {
+            size_t cr = m->row + (m->dir == DIR_DOWN ? i : 0);
+            size_t cc = m->col + (m->dir == DIR_ACROSS ? i : 0);
+            if (s->cover[CELL(p, cr, cc)] & DIR_BIT(dir)) continue;
+            char letter = s->cells[CELL(p, cr, cc)];
+            for (size_t j = 0; j < p->len[w]; ++j) {
+                if (p->text[w][j] != letter) continue;
+                if (dir == DIR_DOWN ? cr < j : cc < j) continue;
+                size_t row = dir == DIR_DOWN ? cr - j : cr;
+                size_t col = dir == DIR_ACROSS ? cc - j : cc;
+                size_t first;
+                if (!free_fits(s, w, row, col, dir, &first) || first != j) continue;
+                if (out && n < limit) { out[n].word = w; out[n].row = row; out[n].col = col; out[n].dir = dir; }
+                ++n;
+            }
+        }
+    }
+    return n;
+}
+
+/* first word: longest one, centred across or down */
+static size_t free_first_moves(const CtorState *s, Move **out) {
+    const CtorProblem *p = s->p;
+    size_t best = 0;
+    for (size_t w = 1; w < p->nwords; ++w) {
+        if (p->len[w] > p->len[best]) best = w;
+        else if (p->len[w] == p->len[best]) {
+            Move a = { w, 0, 0, DIR_ACROSS }, b = { best, 0, 0, DIR_ACROSS };
+            if (move_key(p, &a) < move_key(p, &b)) best = w;
+        }
+    }
+    Move *moves = (Move*)malloc(2 * sizeof(Move));
+    if (!moves) return 0;
+    size_t n = 0, len = p->len[best];
+    if (len <= p->cols) moves[n++] = (Move){ best, p->rows / 2, (p->cols - len) / 2, DIR_ACROSS };
+    if (len <= p->rows) moves[n++] = (Move){ best, (p->rows - len) / 2, p->cols / 2, DIR_DOWN };
+    order_moves(p, moves, n);
+    *out = moves;
+    return n;
+}
+
+typedef struct { size_t word, count; } WordCount;
+
+static int word_count_cmp(const void *a, const void *b) {
+    const WordCount *x = (const WordCount*)a, *y = (const WordCount*)b;
+    if (x->count != y->count) return (x->count > y->count) - (x->count < y->count);
+    return (x->word > y->word) - (x->word < y->word);
+}
+
+/* A word with no crossing today may gain one once other words are down,
+   so unlike a pattern slot its domain keeps growing. The node therefore
+   offers every unplaced word, most constrained (fewest placements) first;
+   only when no word fits anywhere is the branch dead. */
+static size_t free_moves(const CtorState *s, Move **out) {
+    const CtorProblem *p = s->p;
+    if (s->depth == 0) return free_first_moves(s, out);
+
+    WordCount *wc = (WordCount*)malloc(p->nwords * sizeof(WordCount));
+    if (!wc) return 0;
+    size_t nw = 0, total = 0;
+    for (size_t w = 0; w < p->nwords; ++w) {
+        if (s->used[w]) continue;
+        size_t n = free_placements(s, w, NULL, 0);
+        if (n == 0) continue;
+        wc[nw].word = w;
+        wc[nw].count = n;
+        ++nw;
+        total += n;
+    }
+    Move *moves = total ? (Move*)malloc(total * sizeof(Move)) : NULL;
+    if (!moves) { free(wc); return 0; }
+    qsort(wc, nw, sizeof(WordCount), word_count_cmp);
+    size_t n = 0;
+    for (size_t i = 0; i < nw; ++i) {
+        free_placements(s, wc[i].word, moves + n, wc[i].count);
+        order_moves(p, moves + n, wc[i].count);
+        n += wc[i].count;
+    }
+    free(wc);
+    *out = moves;
+    return n;
+}
+
+/* ---------------- Pattern fill ---------------- */
+
+/* the slot's current letters as an index pattern ('?' = still open) */
+static void slot_pattern(const CtorState *s, const Slot *sl, char out[MAX_WORD_LEN]) {
+    const CtorProblem *p = s->p;
+    for (size_t k = 0; k < sl->len; ++k) {
+        char g = s->cells[CELL(p, sl->row + (sl->dir == DIR_DOWN ? k : 0),
+                                  sl->col + (sl->dir == DIR_ACROSS ? k : 0))];
+        out[k] = g == '.' ? WI_WILDCARD : g;
+    }
+    out[sl->len] = '\0';
+}
+
+/* unused words that fit the slot's current letters (bitset AND + popcount) */
+static size_t slot_count(const CtorState *s, const Slot *sl) {
+    if (sl->len >= MAX_WORD_LEN) return 0;
+    char pat[MAX_WORD_LEN];
+    slot_pattern(s, sl, pat);
+    return wi_count(&s->p->index, pat, s->used_bits[sl->len]);
+}
+
+/* write the slot's candidates to out (sized by a previous slot_count) */
+static size_t slot_candidates(CtorState *s, const Slot *sl, Move *out) {
+    if (sl->len >= MAX_WORD_LEN) return 0;
+    char pat[MAX_WORD_LEN];
+    slot_pattern(s, sl, pat);
+    const WordIndexBucket *b = wi_bucket(&s->p->index, sl->len);
+    wi_query(&s->p->index, pat, s->used_bits[sl->len], s->scratch);
+    size_t n = 0;
+    for (size_t k = 0; k < b->nblocks; ++k) {
+        for (uint64_t bits = s->scratch[k]; bits; bits &= bits - 1) {
+            size_t bit = k * 64 + (size_t)ctz64(bits);
+            out[n++] = (Move){ b->ids[bit], sl->row, sl->col, sl->dir };
+        }
+    }
+    return n;
+}
+
+static size_t pattern_moves(CtorState *s, Move **out) {
+    const CtorProblem *p = s->p;
+    size_t best = CW_NO_WORD, best_n = SIZE_MAX;
+    for (size_t i = 0; i < p->nslots && best_n > 1; ++i) {
+        if (s->slot_done[i]) continue;
+        size_t n = slot_count(s, &p->slots[i]);
+        if (n < best_n) { best = i; best_n = n; }
+    }
+    if (best == CW_NO_WORD || best_n == 0) return 0;
+    Move *moves = (Move*)malloc(best_n * sizeof(Move));
+    if (!moves) return 0;
+    best_n = slot_candidates(s, &p->slots[best], moves);
+    order_moves(p, moves, best_n);
+    *out = moves;
+    return best_n;
+}
+
+/* forward check: every open slot crossing the move must still have a word */
+static bool pattern_consistent(const CtorState *s, const Move *m) {
+    const CtorProblem *p = s->p;
+    Direction other = m->dir == DIR_ACROSS ? DIR_DOWN : DIR_ACROSS;
+    for (size_t k = 0; k < p->len[m->word]; ++k) {
+        size_t r = m->row + (m->dir == DIR_DOWN ? k : 0);
+        size_t c = m->col + (m->dir == DIR_ACROSS ? k : 0);
+        size_t t = p->cell_slot[CELL(p, r, c) * 2 + (size_t)other];
+        if (t == CW_NO_WORD || s->slot_done[t]) continue;
+        if (slot_count(s, &p->slots[t]) == 0) return false;
+    }
+    return true;
+}
+
+/* ---------------- Depth-first search ---------------- */
+
+static bool search_complete(const CtorState *s) {
+    return s->depth == (s->p->free_form ? s->p->nwords : s->p->nslots);
+}
+
+static bool search(CtorState *s) {
+    if (search_complete(s)) return true;
+    Move *moves = NULL;
+    size_t n = s->p->free_form ? free_moves(s, &moves) : pattern_moves(s, &moves);
+    for (size_t i = 0; i < n; ++i) {
+        if (s->max_nodes && s->nodes >= s->max_nodes) { s->aborted = true; break; }
+        if (s->winner && atomic_load_explicit(s->winner, memory_order_relaxed) < s->task) {
+            s->aborted = true;
+            break;
+        }
+        ++s->nodes;
+        apply_move(s, &moves[i]);
+        if ((s->p->free_form || pattern_consistent(s, &moves[i])) && search(s)) {
+            free(moves);
+            return true;
+        }
+        undo_move(s);
+        if (s->aborted) break;
+    }
+    free(moves);
+    ++s->backtracks;
+    return false;
+}
+
+/* turn a solution into a Crossword through the regular add_word path */
+static Crossword *moves_to_crossword(const CtorProblem *p, const Move *moves, size_t n) {
+    Crossword *cw = create_crossword(p->rows, p->cols);
+    if (!cw) return NULL;
+    for (size_t i = 0; i < n; ++i) {
+        const Move *m = &moves[i];
+        const char *clue = p->src[m->word].clue ? p->src[m->word].clue : "";
+        if (!add_word(cw, p->text[m->word], m->row, m->col, m->dir, clue)) {
+            destroy_crossword(cw);
+            return NULL;
+        }
+    }
+    if (!crossword_is_connected(cw)) { destroy_crossword(cw); return NULL; }
+    return cw;
+}
+
+/* ---------------- Parallel search ---------------- */
+
+#define SPLIT_MAX_TASKS   65536u
+#define SPLIT_MAX_DEPTH   6u
+#define SPLIT_TASKS_PER_THREAD 8u
+
+/* Subtree roots in sequential (DFS) order, plus what each task found. */
+typedef struct {
+    const CtorProblem *p;
+    const char *pattern;
+    unsigned long max_nodes;
+    size_t  depth;              /* stride of prefixes */
+    Move   *prefixes;           /* ntasks * depth */
+    size_t *prefix_len;
+    size_t  ntasks, cap;
+    Move  **found;              /* per task: winning move list or NULL */
+    _Atomic size_t winner;      /* lowest task index that succeeded */
+    atomic_ulong nodes, backtracks;
+} Split;
+
+static void split_free(Split *sp) {
+    if (sp->found)
+        for (size_t i = 0; i < sp->ntasks; ++i) free(sp->found[i]);
+    free(sp->found);
+    free(sp->prefixes);
+    free(sp->prefix_len);
+    sp->found = NULL;
+    sp->prefixes = NULL;
+    sp->prefix_len = NULL;
+    sp->ntasks = sp->cap = 0;
+}
+
+static bool split_push(Split *sp, const CtorState *s) {
+    if (sp->ntasks == SPLIT_MAX_TASKS) return false;
+    if (sp->ntasks == sp->cap) {
+        size_t cap = sp->cap ? sp->cap * 2 : 64;
+        Move *pm = (Move*)realloc(sp->prefixes, cap * sp->depth * sizeof(Move));
+        if (!pm) return false;
+        sp->prefixes = pm;
+        size_t *pl = (size_t*)realloc(sp->prefix_len, cap * sizeof(size_t));
+        if (!pl) return false;
+        sp->prefix_len = pl;
+        sp->cap = cap;
+    }
+    memcpy(sp->prefixes + sp->ntasks * sp->depth, s->stack, s->depth * sizeof(Move));
+    sp->prefix_len[sp->ntasks++] = s->depth;
+    return true;
+}
+
+/* Walk the top `depth` levels exactly like search() and record every
+   surviving node at that depth (or any earlier complete one). */
+static bool split_collect(Split *sp, CtorState *s, size_t base) {
+    if (s->depth - base == sp->depth || search_complete(s)) return split_push(sp, s);
+    Move *moves = NULL;
+    size_t n = s->p->free_form ? free_moves(s, &moves) : pattern_moves(s, &moves);
+    bool ok = true;
+    for (size_t i = 0; i < n && ok; ++i) {
+        apply_move(s, &moves[i]);
+        if (s->p->free_form || pattern_consistent(s, &moves[i])) ok = split_collect(sp, s, base);
+        undo_move(s);
+    }
+    free(moves);
+    return ok;
+}
+
+static void run_split_task(void *arg, size_t task, unsigned worker) {
+    (void)worker;
+    Split *sp = (Split*)arg;
+    if (atomic_load(&sp->winner) < task) return;
+    CtorState s;
+    if (state_init(&s, sp->p, sp->pattern, sp->max_nodes)) {
+        s.winner = &sp->winner;
+        s.task = task;
+        const Move *prefix = sp->prefixes + task * sp->depth;
+        for (size_t k = 0; k < sp->prefix_len[task]; ++k) apply_move(&s, &prefix[k]);
+        if (search(&s)) {
+            Move *copy = (Move*)malloc(s.depth * sizeof(Move));
+            if (copy) {
+                memcpy(copy, s.stack, s.depth * sizeof(Move));
+                sp->found[task] = copy;
+                size_t cur = atomic_load(&sp->winner);
+                while (task < cur && !atomic_compare_exchange_weak(&sp->winner, &cur, task)) {}
+            }
+        }
+        atomic_fetch_add(&sp->nodes, s.nodes);
+        atomic_fetch_add(&sp->backtracks, s.backtracks);
+    }
+    state_free(&s);
+}
+
+static Crossword *construct_parallel(const CtorProblem *p, const CtorOptions *opt, CtorStats *stats) {
+    CtorState root;
+    if (!state_init(&root, p, opt->pattern, 0)) { state_free(&root); return NULL; }
+
+    /* deepen the split until there is enough work to keep every worker busy */
+    Split sp;
+    memset(&sp, 0, sizeof sp);
+    sp.p = p;
+    sp.pattern = opt->pattern;
+    sp.max_nodes = opt->max_nodes;
+    size_t want = (size_t)opt->threads * SPLIT_TASKS_PER_THREAD;
+    size_t max_depth = opt->split_depth ? opt->split_depth : SPLIT_MAX_DEPTH;
+    for (size_t d = 1; d <= max_depth; ++d) {
+        Split next = sp;
+        next.prefixes = NULL; next.prefix_len = NULL;
+        next.ntasks = next.cap = 0;
+        next.depth = d;
+        if (!split_collect(&next, &root, 0)) { split_free(&next); break; }
+        split_free(&sp);
+        sp = next;
+        if (!opt->split_depth && sp.ntasks >= want) break;
+    }
+    state_free(&root);
+
+    Crossword *cw = NULL;
+    sp.found = sp.ntasks ? (Move**)calloc(sp.ntasks, sizeof(Move*)) : NULL;
+    if (sp.found) {
+        atomic_init(&sp.winner, SIZE_MAX);
+        atomic_init(&sp.nodes, 0);
+        atomic_init(&sp.backtracks, 0);
+        workpool_run(opt->threads, sp.ntasks, run_split_task, &sp);
+        size_t w = atomic_load(&sp.winner);
+        if (w != SIZE_MAX)
+            cw = moves_to_crossword(p, sp.found[w], p->free_form ? p->nwords : p->nslots);
+        if (stats) { stats->nodes = atomic_load(&sp.nodes); stats->backtracks = atomic_load(&sp.backtracks); }
+    }
+    split_free(&sp);
+    return cw;
+}
+
+Crossword *construct_crossword(const CtorWord *words, size_t count,
+                               const CtorOptions *opt, CtorStats *stats)
+{
+    if (stats) { stats->nodes = 0; stats->backtracks = 0; }
+    if (!words || !opt) return NULL;
+    CtorProblem p;
+    Crossword *cw = NULL;
+    if (problem_init(&p, words, count, opt)) {
+        if (opt->threads > 1) {
+            cw = construct_parallel(&p, opt, stats);
+        } else {
+            CtorState s;
+            if (state_init(&s, &p, opt->pattern, opt->max_nodes) && search(&s))
+                cw = moves_to_crossword(&p, s.stack, s.depth);
+            if (stats) { stats->nodes = s.nodes; stats->backtracks = s.backtracks; }
+            state_free(&s);
+        }
+    }
+    problem_free(&p);
+    return cw;
+}
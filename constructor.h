@@ -0,0 +1,45 @@
+#ifndef CONSTRUCTOR_H
+#define CONSTRUCTOR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "crossword.h"
+
+/* One candidate answer for the constructor */
+typedef struct {
+    const char *text;
+    const char *clue;           /* may be NULL (stored as "") */
+} CtorWord;
+
+typedef struct {
+    size_t rows, cols;
+    /* NULL: free-form, every word is placed and each one after the first
+       crosses a word already on the board.
+       Otherwise rows*cols chars, '#' = block, anything else = open cell;
+       every across/down run of 2+ open cells is filled from the word list. */
+    const char *pattern;
+    unsigned long seed;         /* candidate order; same seed -> same board */
+    unsigned long max_nodes;    /* search budget (per parallel task), 0 = unlimited */
+    /* Parallel search: the tree is split into subtrees at split_depth
+       (0 = automatic) and run on `threads` work-stealing workers (0/1 =
+       sequential). With max_nodes == 0 the result is the one the
+       sequential search would find, whatever the thread count. With a
+       budget each task gets max_nodes of its own, so a task may give up
+       where the sequential search would not (or succeed where it would
+       run out); the board is still the same for a given seed, threads
+       and split_depth, but may differ from the sequential one. */
+    unsigned threads;
+    unsigned split_depth;
+} CtorOptions;
+
+typedef struct {
+    unsigned long nodes;        /* placements tried */
+    unsigned long backtracks;   /* dead ends undone */
+} CtorStats;
+
+/* Build a connected crossword from the word list, or NULL if none was
+   found (within the budget). stats may be NULL. */
+Crossword *construct_crossword(const CtorWord *words, size_t count,
+                               const CtorOptions *opt, CtorStats *stats);
+
+#endif
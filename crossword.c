@@ -1,145 +1,417 @@
 #include "crossword.h"
+#include "render.h"
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 static inline char up(char c) { return (char)toupper((unsigned char)c); }
 
 Crossword *create_crossword(size_t rows, size_t cols) {
-    if (rows > MAX_GRID) rows = MAX_GRID;
-    if (cols > MAX_GRID) cols = MAX_GRID;
+    if (rows > UINT32_MAX || cols > UINT32_MAX) return NULL;    /* word_row/word_col */
+    if (rows && cols > SIZE_MAX / 2 / sizeof(size_t) / rows) return NULL;
     Crossword *cw = (Crossword*)calloc(1, sizeof(Crossword));
     if (!cw) return NULL;
     cw->rows = rows;
     cw->cols = cols;
-    for (size_t r = 0; r < rows; ++r)
-        for (size_t c = 0; c < cols; ++c)
-            cw->cells[r][c] = '.';
+    size_t ncells = rows * cols;
+    cw->cells = (char*)malloc(ncells ? ncells : 1);
+    if (!cw->cells) { free(cw); return NULL; }
+    memset(cw->cells, '.', ncells);
+    cw->owner = (size_t*)malloc(ncells ? ncells * 2 * sizeof(size_t) : 1);
+    if (!cw->owner) { free(cw->cells); free(cw); return NULL; }
+    for (size_t i = 0; i < ncells * 2; ++i) cw->owner[i] = CW_NO_WORD;
     cw->word_count = 0;
     return cw;
 }
 
 void destroy_crossword(Crossword *cw) {
+    if (!cw || cw->prebuilt) return;
+    free(cw->word_row);
+    free(cw->word_col);
+    free(cw->word_len);
+    free(cw->word_dir);
+    free(cw->word_text);
+    free(cw->word_clue);
+    free(cw->pool);
+    free(cw->dsu_parent);
+    free(cw->dsu_rank);
+    free(cw->answer_slot);
+    free(cw->answer_next);
+    free(cw->owner);
+    free(cw->cells);
     free(cw);
 }
 
-static bool fits_and_matches(const Crossword *cw, const char *text,
+/* realloc one word array to `cap` entries; it keeps its old block on failure */
+#define GROW_ARRAY(arr, cap) do {                                  \
+        void *grown_ = realloc((arr), (cap) * sizeof *(arr));      \
+        if (!grown_) return false;                                 \
+        (arr) = grown_;                                            \
+    } while (0)
+
+/* grow the word arrays (doubling) so they can hold at least `need` words */
+static bool reserve_words(Crossword *cw, size_t need) {
+    if (need <= cw->word_cap) return true;
+    if (cw->prebuilt) return false;
+    size_t cap = cw->word_cap ? cw->word_cap : 8;
+    while (cap < need) {
+        if (cap > SIZE_MAX / 2 / sizeof(size_t)) return false;
+        cap *= 2;
+    }
+    GROW_ARRAY(cw->word_row, cap);
+    GROW_ARRAY(cw->word_col, cap);
+    GROW_ARRAY(cw->word_len, cap);
+    GROW_ARRAY(cw->word_dir, cap);
+    GROW_ARRAY(cw->word_text, cap);
+    GROW_ARRAY(cw->word_clue, cap);
+    GROW_ARRAY(cw->dsu_parent, cap);
+    GROW_ARRAY(cw->dsu_rank, cap);
+    GROW_ARRAY(cw->answer_next, cap);
+    cw->word_cap = cap;
+    return true;
+}
+
+/* make room for `extra` more bytes in the string pool */
+static bool reserve_pool(Crossword *cw, size_t extra) {
+    if (extra <= cw->pool_cap - cw->pool_len) return true;
+    if (cw->prebuilt) return false;
+    size_t cap = cw->pool_cap ? cw->pool_cap : 256;
+    while (cap - cw->pool_len < extra) {
+        if (cap > SIZE_MAX / 2) return false;
+        cap *= 2;
+    }
+    GROW_ARRAY(cw->pool, cap);
+    cw->pool_cap = cap;
+    return true;
+}
+
+/* copy n bytes plus a NUL into the (reserved) pool; returns the offset */
+static size_t pool_add(Crossword *cw, const char *s, size_t n) {
+    size_t off = cw->pool_len;
+    memcpy(cw->pool + off, s, n);
+    cw->pool[off + n] = '\0';
+    cw->pool_len += n + 1;
+    return off;
+}
+
+/* clues are cut at MAX_CLUE_LEN-1 bytes, as they always have been */
+static size_t clue_length(const char *clue) {
+    const char *end = (const char*)memchr(clue, '\0', MAX_CLUE_LEN - 1);
+    return end ? (size_t)(end - clue) : MAX_CLUE_LEN - 1;
+}
+
+/* ---------------- Answer index ---------------- */
+
+/* FNV-1a: answers are short */
+static size_t answer_hash(const char *s, size_t n) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < n; ++i) h = (h ^ (unsigned char)s[i]) * 0x100000001B3ull;
+    return (size_t)(h ^ (h >> 32));
+}
+
+/* slot of answer text in the index: its first word's, or the free one
+   where it would go */
+static size_t answer_probe(const Crossword *cw, const char *text, size_t n) {
+    size_t mask = cw->answer_cap - 1;
+    size_t j = answer_hash(text, n) & mask;
+    for (size_t w; (w = cw->answer_slot[j]) != CW_NO_WORD; j = (j + 1) & mask)
+        if (cw->word_len[w] == n && memcmp(cw_word_text(cw, w), text, n) == 0) break;
+    return j;
+}
+
+/* keep the index at most half full with `need` words in the puzzle (an
+   upper bound on distinct answers) */
+static bool reserve_answers(Crossword *cw, size_t need) {
+    if (need * 2 <= cw->answer_cap) return true;
+    if (cw->prebuilt) return false;
+    size_t cap = cw->answer_cap ? cw->answer_cap : 16;
+    while (cap < need * 2) {
+        if (cap > SIZE_MAX / 2 / sizeof(size_t)) return false;
+        cap *= 2;
+    }
+    size_t *slots = (size_t*)malloc(cap * sizeof(size_t));
+    if (!slots) return false;
+    for (size_t j = 0; j < cap; ++j) slots[j] = CW_NO_WORD;
+    size_t *old = cw->answer_slot;
+    size_t old_cap = cw->answer_cap;
+    cw->answer_slot = slots;
+    cw->answer_cap = cap;
+    /* chains move whole: only their first words are rehashed */
+    for (size_t j = 0; j < old_cap; ++j) {
+        size_t w = old[j];
+        if (w != CW_NO_WORD) cw->answer_slot[answer_probe(cw, cw_word_text(cw, w), cw->word_len[w])] = w;
+    }
+    free(old);
+    return true;
+}
+
+/* add word idx (answer already in the pool) to the end of its answer's chain */
+static void index_answer(Crossword *cw, size_t idx) {
+    size_t j = answer_probe(cw, cw_word_text(cw, idx), cw->word_len[idx]);
+    cw->answer_next[idx] = CW_NO_WORD;
+    size_t w = cw->answer_slot[j];
+    if (w == CW_NO_WORD) { cw->answer_slot[j] = idx; return; }
+    while (cw->answer_next[w] != CW_NO_WORD) w = cw->answer_next[w];
+    cw->answer_next[w] = idx;
+}
+
+size_t crossword_find_answer(const Crossword *cw, const char *text, size_t n) {
+    if (!cw->answer_cap) return CW_NO_WORD;
+    return cw->answer_slot[answer_probe(cw, text, n)];
+}
+
+/* ---------------- Union-find over words ---------------- */
+
+size_t crossword_find_component(Crossword *cw, size_t word_index) {
+    size_t x = word_index;
+    while (cw->dsu_parent[x] != x) {
+        cw->dsu_parent[x] = cw->dsu_parent[cw->dsu_parent[x]]; /* path halving */
+        x = cw->dsu_parent[x];
+    }
+    return x;
+}
+
+static void dsu_union(Crossword *cw, size_t a, size_t b) {
+    a = crossword_find_component(cw, a);
+    b = crossword_find_component(cw, b);
+    if (a == b) return;
+    if (cw->dsu_rank[a] < cw->dsu_rank[b]) { size_t t = a; a = b; b = t; }
+    cw->dsu_parent[b] = a;
+    if (cw->dsu_rank[a] == cw->dsu_rank[b]) ++cw->dsu_rank[a];
+    --cw->components;
+}
+
+size_t crossword_component_count(const Crossword *cw) {
+    return cw->components;
+}
+
+bool crossword_is_connected(const Crossword *cw) {
+    return cw->components <= 1;
+}
+
+/* U is uppercase, n letters */
+static bool fits_and_matches(const Crossword *cw, const char *U, size_t n,
                              size_t row, size_t col, Direction dir)
 {
-    size_t len = strlen(text);
-    if (dir == DIR_ACROSS && col + len > cw->cols) return false;
-    if (dir == DIR_DOWN && row + len > cw->rows) return false;
+    if (row >= cw->rows || col >= cw->cols) return false;
+    if (dir == DIR_ACROSS && n > cw->cols - col) return false;
+    if (dir == DIR_DOWN && n > cw->rows - row) return false;
 
-    for (size_t i = 0; i < len; ++i) {
+    for (size_t i = 0; i < n; ++i) {
         size_t rr = row + (dir == DIR_DOWN ? i : 0);
         size_t cc = col + (dir == DIR_ACROSS ? i : 0);
-        char gridc = cw->cells[rr][cc];
-        char want = up(text[i]);
-        if (gridc != '.' && gridc != want) return false;
+        char gridc = CW_CELL(cw, rr, cc);
+        if (gridc != '.' && gridc != U[i]) return false;
+        /* words may cross but never share cells in the same direction */
+        if (CW_OWNER(cw, rr, cc, dir) != CW_NO_WORD) return false;
     }
     return true;
 }
 
-static void place_word(Crossword *cw, const char *text,
+static void place_word(Crossword *cw, const char *U, size_t n,
                        size_t row, size_t col, Direction dir)
 {
-    size_t len = strlen(text);
-    for (size_t i = 0; i < len; ++i) {
+    for (size_t i = 0; i < n; ++i) {
         size_t rr = row + (dir == DIR_DOWN ? i : 0);
         size_t cc = col + (dir == DIR_ACROSS ? i : 0);
-        cw->cells[rr][cc] = up(text[i]);
+        CW_CELL(cw, rr, cc) = U[i];
+    }
+}
+
+/* record word U (already uppercase, n letters, cells already written) as
+   the next word: word arrays, ownership, and unions with its crossings.
+   The caller has reserved a word slot, room in the answer index and
+   n+1 + clue_len+1 pool bytes. */
+static void append_word(Crossword *cw, const char *U, size_t n,
+                        size_t row, size_t col, Direction dir,
+                        const char *clue, size_t clue_len)
+{
+    size_t idx = cw->word_count++;
+    cw->word_row[idx] = (uint32_t)row;
+    cw->word_col[idx] = (uint32_t)col;
+    cw->word_len[idx] = (uint8_t)n;
+    cw->word_dir[idx] = (uint8_t)dir;
+    cw->word_text[idx] = pool_add(cw, U, n);
+    cw->word_clue[idx] = pool_add(cw, clue, clue_len);
+    index_answer(cw, idx);
+
+    /* new singleton set, joined with every word it crosses */
+    cw->dsu_parent[idx] = idx;
+    cw->dsu_rank[idx] = 0;
+    ++cw->components;
+    Direction other = dir == DIR_ACROSS ? DIR_DOWN : DIR_ACROSS;
+    for (size_t i = 0; i < n; ++i) {
+        size_t rr = row + (dir == DIR_DOWN ? i : 0);
+        size_t cc = col + (dir == DIR_ACROSS ? i : 0);
+        CW_OWNER(cw, rr, cc, dir) = idx;
+        size_t j = CW_OWNER(cw, rr, cc, other);
+        if (j != CW_NO_WORD) dsu_union(cw, idx, j);
     }
 }
 
 bool add_word(Crossword *cw, const char *text, size_t row, size_t col, Direction dir, const char *clue) {
     if (!cw || !text || !text[0] || !clue) return false;
-    if (cw->word_count >= MAX_WORDS) return false;
     char U[MAX_WORD_LEN];
     size_t n = 0;
     for (; text[n] && n < MAX_WORD_LEN - 1; ++n) U[n] = up(text[n]);
     U[n] = '\0';
-    if (n == 0) return false;
-    if (!fits_and_matches(cw, U, row, col, dir)) return false;
-    place_word(cw, U, row, col, dir);
-    Word *w = &cw->words[cw->word_count++];
-    strncpy(w->text, U, MAX_WORD_LEN-1); w->text[MAX_WORD_LEN-1] = '\0';
-    strncpy(w->clue, clue, MAX_CLUE_LEN-1); w->clue[MAX_CLUE_LEN-1] = '\0';
-    w->row = row; w->col = col; w->dir = dir;
-    w->placed = true; w->solved = false;
+    if (!fits_and_matches(cw, U, n, row, col, dir)) return false;
+    size_t clue_len = clue_length(clue);
+    if (!reserve_words(cw, cw->word_count + 1)) return false;
+    if (!reserve_answers(cw, cw->word_count + 1)) return false;
+    if (!reserve_pool(cw, n + 1 + clue_len + 1)) return false;
+    place_word(cw, U, n, row, col, dir);
+    append_word(cw, U, n, row, col, dir, clue, clue_len);
     return true;
 }
 
-void display_crossword(const Crossword *cw, bool reveal) {
-#ifdef _WIN32
-    system("chcp 65001 > nul");
-#endif
-    putchar('\n');
-    for (size_t r = 0; r < cw->rows; ++r) {
-        fputs("    ", stdout);
-        for (size_t c = 0; c < cw->cols; ++c) fputs("┌───", stdout);
-        fputs("┐\n    ", stdout);
-        for (size_t c = 0; c < cw->cols; ++c) {
-            char ch = cw->cells[r][c];
-            if (ch == '.') { fputs("│███", stdout); continue; }
-            printf("│ %c ", reveal ? ch : ' ');
-        }
-        fputs("│\n", stdout);
-    }
-    fputs("    ", stdout);
-    for (size_t c = 0; c < cw->cols; ++c) fputs("└───", stdout);
-    fputs("┘\n", stdout);
+bool add_placed_word(Crossword *cw, const char *text, size_t row, size_t col, Direction dir, const char *clue) {
+    if (!cw || !text || !clue) return false;
+    size_t n = strlen(text);
+    if (n == 0 || n >= MAX_WORD_LEN || row >= cw->rows || col >= cw->cols) return false;
+    if (dir == DIR_ACROSS ? n > cw->cols - col : n > cw->rows - row) return false;
+    size_t clue_len = clue_length(clue);
+    if (!reserve_words(cw, cw->word_count + 1)) return false;
+    if (!reserve_answers(cw, cw->word_count + 1)) return false;
+    if (!reserve_pool(cw, n + 1 + clue_len + 1)) return false;
+    append_word(cw, text, n, row, col, dir, clue, clue_len);
+    return true;
 }
 
-void display_progress(const Crossword *cw) {
-    size_t solved = 0;
-    for (size_t i = 0; i < cw->word_count; ++i) if (cw->words[i].solved) ++solved;
-    double pct = cw->word_count ? (100.0 * solved / (double)cw->word_count) : 100.0;
-    printf("Progress: %zu/%zu solved (%.1f%%)\n", solved, cw->word_count, pct);
+/* ---------------- Sessions ---------------- */
+
+Session *session_create(const Crossword *cw) {
+    size_t nwords = (cw->word_count + 63) / 64;
+    size_t ncells = cw->rows * cw->cols;
+    size_t bits = sizeof(Session) + nwords * sizeof(uint64_t);
+    if (cw->word_count > SIZE_MAX - bits || ncells > SIZE_MAX - bits - cw->word_count) return NULL;
+    Session *s = (Session*)calloc(1, bits + cw->word_count + ncells);
+    if (!s) return NULL;
+    s->word_count = cw->word_count;
+    s->cells = ncells;
+    s->correct = (uint8_t*)s + bits;
+    s->entered = (char*)s->correct + cw->word_count;
+    s->started = time(NULL);
+    return s;
 }
 
-void list_clues(const Crossword *cw, bool show_status) {
-    puts("\nAcross:");
-    for (size_t i = 0; i < cw->word_count; ++i) {
-        const Word *w = &cw->words[i];
-        if (w->dir != DIR_ACROSS) continue;
-        printf("  %2zu) (%zu,%zu) %s%s\n", i, w->row, w->col, w->clue,
-               show_status ? (w->solved ? "  [solved]" : "") : "");
-    }
-    puts("Down:");
-    for (size_t i = 0; i < cw->word_count; ++i) {
-        const Word *w = &cw->words[i];
-        if (w->dir != DIR_DOWN) continue;
-        printf("  %2zu) (%zu,%zu) %s%s\n", i, w->row, w->col, w->clue,
-               show_status ? (w->solved ? "  [solved]" : "") : "");
-    }
+void session_destroy(Session *s) {
+    free(s);
+}
+
+/* frame reused across renders; composed in memory and written in one go */
+static FrameBuf display_frame;
+
+void display_crossword(const Crossword *cw, const Session *s, DisplayMode mode) {
+    render_crossword(cw, s, mode, &display_frame);
+    fb_flush(&display_frame, stdout);
+}
+
+void display_progress(const Crossword *cw, const Session *s) {
+    render_progress(cw, s, &display_frame);
+    fb_flush(&display_frame, stdout);
+}
+
+void list_clues(const Crossword *cw, const Session *s) {
+    render_clues(cw, s, &display_frame);
+    fb_flush(&display_frame, stdout);
 }
 
 void show_solution(const Crossword *cw) {
-    puts("\nSOLUTION:");
-    display_crossword(cw, true);
-    for (size_t i = 0; i < cw->word_count; ++i) {
-        const Word *w = &cw->words[i];
-        printf("  %2zu) %s (%s) at (%zu,%zu)\n",
-               i, w->text, w->dir == DIR_ACROSS ? "ACROSS" : "DOWN", w->row, w->col);
+    render_solution(cw, &display_frame);
+    fb_flush(&display_frame, stdout);
+}
+
+/* uppercase copy of guess into buf (MAX_WORD_LEN); returns its length */
+static size_t normalize_guess(const char *guess, char *buf) {
+    size_t n = 0;
+    for (; guess[n] && n < MAX_WORD_LEN - 1; ++n) buf[n] = up(guess[n]);
+    buf[n] = '\0';
+    return n;
+}
+
+static void set_solved_bit(Session *s, size_t word_index) {
+    s->solved[word_index / 64] |= (uint64_t)1 << (word_index % 64);
+    ++s->solved_count;
+}
+
+/* Store ch (uppercase or '\0') in cell (r,c) and move the correct-letter
+   counters of the one or two words through it; a word reaching its length
+   is solved and reported in completed[]. O(1): nothing is rescanned. */
+static void set_cell(const Crossword *cw, Session *s, size_t r, size_t c, char ch,
+                     size_t *completed, size_t *ncompleted) {
+    char *cell = &s->entered[r * cw->cols + c];
+    char answer = CW_CELL(cw, r, c);
+    int delta = (ch == answer) - (*cell == answer);
+    *cell = ch;
+    if (delta == 0) return;
+    for (int d = DIR_ACROSS; d <= DIR_DOWN; ++d) {
+        size_t w = CW_OWNER(cw, r, c, d);
+        if (w == CW_NO_WORD) continue;
+        s->correct[w] = (uint8_t)(s->correct[w] + delta);
+        if (s->correct[w] == cw->word_len[w] && !session_word_solved(s, w)) {
+            set_solved_bit(s, w);
+            if (completed) completed[(*ncompleted)++] = w;
+        }
     }
 }
 
-bool make_guess(Crossword *cw, const char *guess, size_t word_index) {
-    if (!cw || word_index >= cw->word_count || !guess) return false;
+/* word solved as a whole: its letters go into the grid, which may in
+   turn complete words crossing it */
+static void mark_solved(const Crossword *cw, Session *s, size_t word_index) {
+    if (session_word_solved(s, word_index)) return;
+    set_solved_bit(s, word_index);
+    if (s->cells != cw->rows * cw->cols) return;
+    const char *text = cw_word_text(cw, word_index);
+    size_t r = cw->word_row[word_index], c = cw->word_col[word_index];
+    bool across = cw->word_dir[word_index] == DIR_ACROSS;
+    for (size_t i = 0; i < cw->word_len[word_index]; ++i)
+        set_cell(cw, s, r + (across ? 0 : i), c + (across ? i : 0), text[i], NULL, NULL);
+}
+
+bool make_guess(const Crossword *cw, Session *s, const char *guess, size_t word_index) {
+    if (!cw || !s || word_index >= cw->word_count || word_index >= s->word_count || !guess) return false;
     char upg[MAX_WORD_LEN];
-    size_t n = 0;
-    for (; guess[n] && n < MAX_WORD_LEN - 1; ++n) upg[n] = up(guess[n]);
-    upg[n] = '\0';
-    if (strcmp(upg, cw->words[word_index].text) == 0) {
-        cw->words[word_index].solved = true;
-        return true;
+    size_t n = normalize_guess(guess, upg);
+    if (n != cw->word_len[word_index] || memcmp(upg, cw_word_text(cw, word_index), n) != 0) return false;
+    mark_solved(cw, s, word_index);
+    return true;
+}
+
+size_t make_guess_any(const Crossword *cw, Session *s, const char *guess,
+                      size_t *solved, size_t max, bool *matched) {
+    if (matched) *matched = false;
+    if (!cw || !s || !guess || s->word_count != cw->word_count) return 0;
+    char upg[MAX_WORD_LEN];
+    size_t n = normalize_guess(guess, upg);
+    size_t count = 0;
+    for (size_t w = crossword_find_answer(cw, upg, n); w != CW_NO_WORD; w = cw->answer_next[w]) {
+        if (matched) *matched = true;
+        if (session_word_solved(s, w)) continue;
+        mark_solved(cw, s, w);
+        if (count < max) solved[count] = w;
+        ++count;
     }
-    return false;
+    return count;
 }
 
-bool is_puzzle_complete(const Crossword *cw) {
-    for (size_t i = 0; i < cw->word_count; ++i)
-        if (!cw->words[i].solved) return false;
+bool enter_letter(const Crossword *cw, Session *s, size_t r, size_t c, char letter,
+                  size_t completed[2], size_t *ncompleted) {
+    size_t none;
+    if (!ncompleted) ncompleted = &none;
+    *ncompleted = 0;
+    if (!cw || !s || s->word_count != cw->word_count || s->cells != cw->rows * cw->cols) return false;
+    if (r >= cw->rows || c >= cw->cols || CW_CELL(cw, r, c) == '.') return false;
+    char ch = letter == ' ' ? '\0' : up(letter);
+    if (ch && (ch < 'A' || ch > 'Z')) return false;
+    if (session_cell_revealed(cw, s, r, c)) return false;
+    size_t done[2];
+    set_cell(cw, s, r, c, ch, completed ? completed : done, ncompleted);
     return true;
 }
+
+bool is_puzzle_complete(const Crossword *cw, const Session *s) {
+    return s && s->word_count == cw->word_count && s->solved_count == cw->word_count;
+}
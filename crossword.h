@@ -3,58 +3,151 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 
 #define MAX_WORD_LEN   32
 #define MAX_CLUE_LEN   128
-#define MAX_GRID       12
-#define MAX_WORDS      32
 
 typedef enum { DIR_ACROSS = 0, DIR_DOWN = 1 } Direction;
 
-typedef struct {
-    char text[MAX_WORD_LEN];
-    char clue[MAX_CLUE_LEN];
-    size_t row, col;       // start position
-    Direction dir;
-    bool placed;
-    bool solved;
-} Word;
+/* What display_crossword shows inside letter cells */
+typedef enum {
+    DISPLAY_BLANK  = 0,   // empty boxes
+    DISPLAY_ALL    = 1,   // every answer letter
+    DISPLAY_SOLVED = 2    // only letters of solved words
+} DisplayMode;
 
+/* Words are stored struct-of-arrays: the fields every scan needs
+   (position, length, direction) sit in dense parallel arrays, while the
+   answers and clues are NUL-terminated strings in one pool, reached by
+   offset only when printed or compared. Solved bits live in Session. */
 typedef struct {
     size_t rows, cols;
-    char   cells[MAX_GRID][MAX_GRID]; // '.' for block/empty, 'A'..'Z' for letters
+    char  *cells;          // rows*cols, row-major; '.' for block/empty, 'A'..'Z' for letters
     size_t word_count;
-    Word   words[MAX_WORDS];
+    size_t word_cap;       // allocated slots in each word array
+    uint32_t *word_row;    // start position
+    uint32_t *word_col;
+    uint8_t  *word_len;    // letters in the answer (< MAX_WORD_LEN)
+    uint8_t  *word_dir;    // Direction
+    size_t   *word_text;   // pool offset of the uppercase answer
+    size_t   *word_clue;   // pool offset of the clue
+    char  *pool;           // answer and clue strings
+    size_t pool_len, pool_cap;
+    size_t *owner;         // rows*cols*2: index of the across/down word covering each cell
+    size_t *dsu_parent;    // union-find over words, joined on every crossing
+    unsigned char *dsu_rank;
+    size_t components;     // number of disjoint word groups
+    size_t *answer_slot;   // answer_cap (power of two): first word of each distinct
+    size_t answer_cap;     //   answer, open addressing on its hash; CW_NO_WORD if free
+    size_t *answer_next;   // next word with the same answer, CW_NO_WORD at the end
+    bool prebuilt;         // static storage from puzzles_gen.c: never freed or grown
 } Crossword;
 
+/* One player's progress on a Crossword. The puzzle is only read, so any
+   number of sessions can share it; a session is a solved-word bitmask,
+   the letters entered cell by cell with a count of the correct ones in
+   each word, and timing, allocated in one block. */
+typedef struct {
+    size_t word_count;     // words in the puzzle the session was created for
+    size_t solved_count;
+    size_t cells;          // rows*cols of that puzzle
+    time_t started;
+    char    *entered;      // cells: letter entered in each cell, '\0' if none
+    uint8_t *correct;      // word_count: entered letters that match the answer
+    uint64_t solved[];     // bit i set once word i is solved
+} Session;
+
+#define CW_NO_WORD ((size_t)-1)
+
+/* Cell (r,c) of the row-major grid buffer */
+#define CW_CELL(cw, r, c) ((cw)->cells[(r) * (cw)->cols + (c)])
+/* Word covering cell (r,c) in direction dir, or CW_NO_WORD */
+#define CW_OWNER(cw, r, c, dir) ((cw)->owner[((r) * (cw)->cols + (c)) * 2 + (size_t)(dir)])
+
+/* Answer and clue strings of word i */
+static inline const char *cw_word_text(const Crossword *cw, size_t i) {
+    return cw->pool + cw->word_text[i];
+}
+static inline const char *cw_word_clue(const Crossword *cw, size_t i) {
+    return cw->pool + cw->word_clue[i];
+}
+
 /* Crossword management */
 Crossword *create_crossword(size_t rows, size_t cols);
 void destroy_crossword(Crossword *cw);
 
 /* Crossword operations */
 bool add_word(Crossword *cw, const char *text, size_t row, size_t col, Direction dir, const char *clue);
-void display_crossword(const Crossword *cw, bool reveal);
-void display_progress(const Crossword *cw);
-void list_clues(const Crossword *cw, bool show_status);
+/* Like add_word for a word whose letters are already in cells (e.g. a grid
+   copied from a puzzle pack): text must be uppercase; only bounds are
+   checked, letters and overlaps are trusted. */
+bool add_placed_word(Crossword *cw, const char *text, size_t row, size_t col, Direction dir, const char *clue);
 void show_solution(const Crossword *cw);
-bool make_guess(Crossword *cw, const char *guess, size_t word_index);
-bool is_puzzle_complete(const Crossword *cw);
 
-/* ================= GRAPH STRUCTURES ================= */
+/* Sessions: s may be NULL wherever it is const (nothing solved) */
+Session *session_create(const Crossword *cw);
+void session_destroy(Session *s);
+void display_crossword(const Crossword *cw, const Session *s, DisplayMode mode);
+void display_progress(const Crossword *cw, const Session *s);
+void list_clues(const Crossword *cw, const Session *s);
+bool make_guess(const Crossword *cw, Session *s, const char *guess, size_t word_index);
+/* Guess without a clue id: marks every unsolved word whose answer is
+   guess, and returns how many; the first `max` of them go to `solved`.
+   *matched (may be NULL) tells whether the answer is in the puzzle at all. */
+size_t make_guess_any(const Crossword *cw, Session *s, const char *guess,
+                      size_t *solved, size_t max, bool *matched);
+/* Letter entry: put letter (any case; ' ' clears) in cell (r,c). Only the
+   counters of the across and down words through the cell change; a word
+   whose letters are all correct is solved, and its index goes to
+   completed[*ncompleted++] (room for 2; both may be NULL). False if the
+   cell holds no letter, belongs to a solved word, or letter is not A-Z. */
+bool enter_letter(const Crossword *cw, Session *s, size_t r, size_t c, char letter,
+                  size_t completed[2], size_t *ncompleted);
+bool is_puzzle_complete(const Crossword *cw, const Session *s);
 
-typedef struct GraphNode {
-    size_t index;               // index of word
-    struct GraphNode *next;     // adjacency list link
-} GraphNode;
+static inline bool session_word_solved(const Session *s, size_t word_index) {
+    return s && word_index < s->word_count &&
+           (s->solved[word_index / 64] >> (word_index % 64) & 1u);
+}
+
+/* True once a solved word covers cell (r,c) */
+static inline bool session_cell_revealed(const Crossword *cw, const Session *s, size_t r, size_t c) {
+    const size_t *o = &CW_OWNER(cw, r, c, DIR_ACROSS);
+    return session_word_solved(s, o[0]) || session_word_solved(s, o[1]);
+}
+
+/* Letter entered in cell (r,c), '\0' if none */
+static inline char session_cell_entered(const Crossword *cw, const Session *s, size_t r, size_t c) {
+    return s && s->cells == cw->rows * cw->cols ? s->entered[r * cw->cols + c] : '\0';
+}
+
+/* Words whose answer is text (uppercase, n letters), kept up to date by
+   add_word: the first one or CW_NO_WORD, then follow answer_next */
+size_t crossword_find_answer(const Crossword *cw, const char *text, size_t n);
+
+/* Connectivity, kept up to date by add_word */
+size_t crossword_find_component(Crossword *cw, size_t word_index);
+size_t crossword_component_count(const Crossword *cw);
+bool crossword_is_connected(const Crossword *cw);
+
+/* ================= GRAPH STRUCTURES ================= */
 
+/* Compressed sparse row adjacency: the neighbors of vertex i are
+   nbr[offsets[i]] .. nbr[offsets[i+1]-1]. Header and both arrays live in
+   one allocation, so free_graph is a single free. */
 typedef struct {
     size_t num_vertices;
-    GraphNode *adj[MAX_WORDS];
+    size_t num_edges;           // directed entries in nbr (2 per crossing)
+    size_t *offsets;            // num_vertices + 1 entries
+    size_t *nbr;                // num_edges word indices
 } Graph;
 
 Graph *build_crossword_graph(const Crossword *cw);
 void free_graph(Graph *g);
 void dfs_graph(const Graph *g, size_t start, bool visited[]);
+bool dfs_graph_iterative(const Graph *g, size_t start, bool visited[]);
 bool is_crossword_connected(const Graph *g);
 
 #endif
@@ -0,0 +1,381 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "dawg.h"
+#include "crossword.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define EDGE_LETTER(e)   ((e) & 0x1Fu)
+#define EDGE_TERMINAL    0x20u
+#define EDGE_LAST        0x40u
+#define EDGE_CHILD(e)    ((e) >> 7)
+#define DAWG_MAX_EDGES   (1u << 25)
+
+typedef struct {
+    uint32_t magic, version, nedges, root, nwords;
+} DawgHeader;
+
+/* ---------------- Builder (Daciuk et al., sorted input) ---------------- */
+
+typedef struct {
+    uint8_t  letter;
+    uint32_t child;
+} BEdge;
+
+typedef struct {
+    BEdge   *e;
+    uint8_t  n, cap;
+    bool     final;
+} BNode;
+
+typedef struct {
+    BNode    *nodes;
+    uint32_t  count, cap;
+    uint32_t *reg;          /* open-addressing set of registered node ids (+1) */
+    size_t    reg_cap, reg_used;
+    bool      failed;
+} Builder;
+
+static uint32_t new_bnode(Builder *b) {
+    if (b->count == b->cap) {
+        uint32_t cap = b->cap ? b->cap * 2 : 1024;
+        BNode *p = (BNode*)realloc(b->nodes, cap * sizeof(BNode));
+        if (!p) { b->failed = true; return 0; }
+        b->nodes = p;
+        b->cap = cap;
+    }
+    BNode *n = &b->nodes[b->count];
+    n->e = NULL;
+    n->n = n->cap = 0;
+    n->final = false;
+    return b->count++;
+}
+
+static void add_edge(Builder *b, uint32_t from, uint8_t letter, uint32_t child) {
+    BNode *n = &b->nodes[from];
+    if (n->n == n->cap) {
+        uint8_t cap = n->cap ? (uint8_t)(n->cap * 2 > 26 ? 26 : n->cap * 2) : 2;
+        BEdge *e = (BEdge*)realloc(n->e, cap * sizeof(BEdge));
+        if (!e) { b->failed = true; return; }
+        n->e = e;
+        n->cap = cap;
+    }
+    n->e[n->n].letter = letter;
+    n->e[n->n].child = child;
+    ++n->n;
+}
+
+static uint64_t node_hash(const BNode *n) {
+    uint64_t h = 1469598103934665603ull ^ (uint64_t)n->final;
+    for (uint8_t i = 0; i < n->n; ++i) {
+        h = (h ^ n->e[i].letter) * 1099511628211ull;
+        h = (h ^ n->e[i].child) * 1099511628211ull;
+    }
+    return h;
+}
+
+static bool node_equal(const BNode *a, const BNode *b) {
+    if (a->final != b->final || a->n != b->n) return false;
+    for (uint8_t i = 0; i < a->n; ++i)
+        if (a->e[i].letter != b->e[i].letter || a->e[i].child != b->e[i].child) return false;
+    return true;
+}
+
+static bool reg_grow(Builder *b) {
+    size_t cap = b->reg_cap ? b->reg_cap * 2 : 4096;
+    uint32_t *t = (uint32_t*)calloc(cap, sizeof(uint32_t));
+    if (!t) return false;
+    for (size_t i = 0; i < b->reg_cap; ++i) {
+        uint32_t id = b->reg[i];
+        if (!id) continue;
+        size_t j = (size_t)node_hash(&b->nodes[id - 1]) & (cap - 1);
+        while (t[j]) j = (j + 1) & (cap - 1);
+        t[j] = id;
+    }
+    free(b->reg);
+    b->reg = t;
+    b->reg_cap = cap;
+    return true;
+}
+
+/* id of an equivalent registered node, registering `id` if there is none */
+static uint32_t reg_find_or_add(Builder *b, uint32_t id) {
+    if ((b->reg_used + 1) * 2 > b->reg_cap && !reg_grow(b)) { b->failed = true; return id; }
+    const BNode *n = &b->nodes[id];
+    size_t j = (size_t)node_hash(n) & (b->reg_cap - 1);
+    while (b->reg[j]) {
+        if (node_equal(&b->nodes[b->reg[j] - 1], n)) return b->reg[j] - 1;
+        j = (j + 1) & (b->reg_cap - 1);
+    }
+    b->reg[j] = id + 1;
+    ++b->reg_used;
+    return id;
+}
+
+/* fold the unchecked path below depth `keep` into the register */
+static void minimize(Builder *b, uint32_t *path, size_t depth, size_t keep) {
+    for (size_t d = depth; d > keep; --d) {
+        uint32_t child = path[d];
+        uint32_t same = reg_find_or_add(b, child);
+        if (same != child) {
+            BNode *parent = &b->nodes[path[d - 1]];
+            parent->e[parent->n - 1].child = same;
+            free(b->nodes[child].e);        /* duplicate: dropped */
+            b->nodes[child].e = NULL;
+            b->nodes[child].n = 0;
+        }
+    }
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(const char *const*)a, *(const char *const*)b);
+}
+
+static bool valid_word(const char *w) {
+    size_t n = 0;
+    for (; w[n]; ++n) if (n >= MAX_WORD_LEN - 1 || w[n] < 'A' || w[n] > 'Z') return false;
+    return n > 0;
+}
+
+/* lay the reachable nodes out as edge blocks and encode them */
+static bool serialize(Builder *b, uint32_t root, uint32_t nwords, Dawg *out) {
+    uint32_t *offset = (uint32_t*)calloc(b->count, sizeof(uint32_t));
+    uint32_t *queue = (uint32_t*)malloc(b->count * sizeof(uint32_t));
+    if (!offset || !queue) { free(offset); free(queue); return false; }
+
+    uint32_t next = 1, head = 0, tail = 0;          /* edge 0 is the sentinel */
+    if (b->nodes[root].n) { offset[root] = next; next += b->nodes[root].n; queue[tail++] = root; }
+    while (head < tail) {
+        const BNode *n = &b->nodes[queue[head++]];
+        for (uint8_t i = 0; i < n->n; ++i) {
+            uint32_t c = n->e[i].child;
+            if (!b->nodes[c].n || offset[c]) continue;
+            if (next > DAWG_MAX_EDGES - b->nodes[c].n) { free(offset); free(queue); return false; }
+            offset[c] = next;
+            next += b->nodes[c].n;
+            queue[tail++] = c;
+        }
+    }
+
+    size_t len = sizeof(DawgHeader) + (size_t)next * sizeof(uint32_t);
+    unsigned char *img = (unsigned char*)malloc(len);
+    if (!img) { free(offset); free(queue); return false; }
+    DawgHeader h = { DAWG_MAGIC, DAWG_VERSION, next, offset[root], nwords };
+    memcpy(img, &h, sizeof h);
+    uint32_t *edges = (uint32_t*)(img + sizeof h);
+    edges[0] = 0;
+    for (uint32_t q = 0; q < tail; ++q) {
+        const BNode *n = &b->nodes[queue[q]];
+        uint32_t at = offset[queue[q]];
+        for (uint8_t i = 0; i < n->n; ++i) {
+            const BNode *c = &b->nodes[n->e[i].child];
+            uint32_t e = n->e[i].letter;
+            if (c->final) e |= EDGE_TERMINAL;
+            if (i + 1 == n->n) e |= EDGE_LAST;
+            e |= offset[n->e[i].child] << 7;
+            edges[at + i] = e;
+        }
+    }
+    free(offset);
+    free(queue);
+
+    out->base = img;
+    out->base_len = len;
+    out->mapped = false;
+    out->edges = edges;
+    out->nedges = next;
+    out->root = h.root;
+    out->nwords = nwords;
+    return true;
+}
+
+bool dawg_build(const char *const *words, size_t count, Dawg *out) {
+    memset(out, 0, sizeof *out);
+    const char **sorted = (const char**)malloc((count ? count : 1) * sizeof(char*));
+    if (!sorted) return false;
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) if (words[i] && valid_word(words[i])) sorted[n++] = words[i];
+    qsort(sorted, n, sizeof(char*), cmp_str);
+
+    Builder b;
+    memset(&b, 0, sizeof b);
+    uint32_t root = new_bnode(&b);
+    uint32_t path[MAX_WORD_LEN + 1];
+    size_t depth = 0;
+    const char *prev = "";
+    uint32_t nwords = 0;
+    path[0] = root;
+
+    for (size_t i = 0; i < n && !b.failed; ++i) {
+        const char *w = sorted[i];
+        if (strcmp(w, prev) == 0) continue;         /* duplicate */
+        size_t common = 0;
+        while (w[common] && w[common] == prev[common]) ++common;
+        minimize(&b, path, depth, common);
+        depth = common;
+        for (const char *p = w + common; *p && !b.failed; ++p) {
+            uint32_t child = new_bnode(&b);
+            if (b.failed) break;
+            add_edge(&b, path[depth], (uint8_t)(*p - 'A'), child);
+            path[++depth] = child;
+        }
+        if (!b.failed) b.nodes[path[depth]].final = true;
+        prev = w;
+        ++nwords;
+    }
+    minimize(&b, path, depth, 0);
+
+    bool ok = !b.failed && serialize(&b, root, nwords, out);
+    for (uint32_t i = 0; i < b.count; ++i) free(b.nodes[i].e);
+    free(b.nodes);
+    free(b.reg);
+    free(sorted);
+    return ok;
+}
+
+/* ---------------- Image I/O ---------------- */
+
+bool dawg_save(const Dawg *d, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(d->base, 1, d->base_len, f) == d->base_len;
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+/* header sanity: sizes agree, root in range (edges are bounds-checked on use) */
+static bool attach(Dawg *d, void *base, size_t len, bool mapped) {
+    DawgHeader h;
+    if (len < sizeof h) return false;
+    memcpy(&h, base, sizeof h);
+    if (h.magic != DAWG_MAGIC || h.version != DAWG_VERSION) return false;
+    if (h.nedges == 0 || h.nedges > DAWG_MAX_EDGES) return false;
+    if (len != sizeof h + (size_t)h.nedges * sizeof(uint32_t)) return false;
+    if (h.root >= h.nedges) return false;
+    d->base = base;
+    d->base_len = len;
+    d->mapped = mapped;
+    d->edges = (const uint32_t*)((const unsigned char*)base + sizeof h);
+    d->nedges = h.nedges;
+    d->root = h.root;
+    d->nwords = h.nwords;
+    return true;
+}
+
+bool dawg_open(const char *path, Dawg *out) {
+    memset(out, 0, sizeof *out);
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    size_t len = (size_t)st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    if (!attach(out, map, len, true)) { munmap(map, len); return false; }
+    return true;
+#else
+    /* no mmap here: read the image in one go (still no parsing) */
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    if (fseek(f, 0, SEEK_END) != 0) { fclose(f); return false; }
+    long sz = ftell(f);
+    rewind(f);
+    if (sz <= 0) { fclose(f); return false; }
+    void *buf = malloc((size_t)sz);
+    bool ok = buf && fread(buf, 1, (size_t)sz, f) == (size_t)sz;
+    fclose(f);
+    if (!ok || !attach(out, buf, (size_t)sz, false)) { free(buf); return false; }
+    return true;
+#endif
+}
+
+void dawg_close(Dawg *d) {
+    if (!d->base) return;
+#ifndef _WIN32
+    if (d->mapped) munmap(d->base, d->base_len);
+    else
+#endif
+    free(d->base);
+    memset(d, 0, sizeof *d);
+}
+
+/* ---------------- Queries ---------------- */
+
+/* edge for `letter` in the node starting at `first`, or 0 */
+static uint32_t find_edge(const Dawg *d, uint32_t first, uint32_t letter) {
+    for (uint32_t i = first; i && i < d->nedges; ++i) {
+        uint32_t e = d->edges[i];
+        if (EDGE_LETTER(e) == letter) return i;
+        if (e & EDGE_LAST) break;
+    }
+    return 0;
+}
+
+bool dawg_contains(const Dawg *d, const char *word) {
+    if (!d->edges || !word || !word[0]) return false;
+    uint32_t node = d->root;
+    for (const char *p = word; *p; ++p) {
+        char ch = *p;
+        if (ch >= 'a' && ch <= 'z') ch = (char)(ch - 'a' + 'A');
+        if (ch < 'A' || ch > 'Z') return false;
+        uint32_t i = find_edge(d, node, (uint32_t)(ch - 'A'));
+        if (!i) return false;
+        if (!p[1]) return (d->edges[i] & EDGE_TERMINAL) != 0;
+        node = EDGE_CHILD(d->edges[i]);
+    }
+    return false;
+}
+
+typedef struct {
+    const Dawg *d;
+    const char *pattern;
+    size_t len;
+    char buf[MAX_WORD_LEN];
+    void (*fn)(void *ctx, const char *word);
+    void *ctx;
+    size_t count;
+} MatchCtx;
+
+static void match_from(MatchCtx *m, uint32_t node, size_t depth) {
+    char want = m->pattern[depth];
+    bool any = want == '?' || want == '.';
+    if (want >= 'a' && want <= 'z') want = (char)(want - 'a' + 'A');
+    for (uint32_t i = node; i && i < m->d->nedges; ++i) {
+        uint32_t e = m->d->edges[i];
+        char letter = (char)('A' + EDGE_LETTER(e));
+        if (any || letter == want) {
+            m->buf[depth] = letter;
+            if (depth + 1 == m->len) {
+                if (e & EDGE_TERMINAL) {
+                    m->buf[depth + 1] = '\0';
+                    ++m->count;
+                    if (m->fn) m->fn(m->ctx, m->buf);
+                }
+            } else if (EDGE_CHILD(e)) {
+                match_from(m, EDGE_CHILD(e), depth + 1);
+            }
+        }
+        if (e & EDGE_LAST) break;
+    }
+}
+
+size_t dawg_match(const Dawg *d, const char *pattern,
+                  void (*fn)(void *ctx, const char *word), void *ctx)
+{
+    if (!d->edges || !pattern) return 0;
+    MatchCtx m = { d, pattern, strlen(pattern), {0}, fn, ctx, 0 };
+    if (m.len == 0 || m.len >= MAX_WORD_LEN) return 0;
+    match_from(&m, d->root, 0);
+    return m.count;
+}
@@ -0,0 +1,43 @@
+#ifndef DAWG_H
+#define DAWG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Minimized DAWG (directed acyclic word graph) over uppercase A-Z words.
+   The whole dictionary is one flat array of 32-bit edges; the on-disk
+   image is a 20-byte header followed by that array, so dawg_open just
+   maps the file and queries run on it in place.
+
+   Edge layout: bits 0-4 letter (0 = 'A'), bit 5 a word ends here,
+   bit 6 last edge of its node, bits 7-31 index of the child's first
+   edge (0 = no children; edge 0 is a reserved sentinel). */
+
+#define DAWG_MAGIC   0x47574144u   /* "DAWG" little-endian */
+#define DAWG_VERSION 1u
+
+typedef struct {
+    const uint32_t *edges;
+    uint32_t nedges;
+    uint32_t root;          /* first edge of the root node, 0 if empty */
+    uint32_t nwords;
+    void    *base;          /* mapping or heap block holding the image */
+    size_t   base_len;
+    bool     mapped;
+} Dawg;
+
+/* Build from any list of words; entries that are not 1..MAX_WORD_LEN-1
+   letters A-Z are skipped, duplicates are merged. */
+bool dawg_build(const char *const *words, size_t count, Dawg *out);
+bool dawg_save(const Dawg *d, const char *path);
+bool dawg_open(const char *path, Dawg *out);
+void dawg_close(Dawg *d);
+
+bool dawg_contains(const Dawg *d, const char *word);
+/* Calls fn for every word matching pattern ('?' or '.' = any letter), in
+   alphabetical order. fn may be NULL to just count. Returns the count. */
+size_t dawg_match(const Dawg *d, const char *pattern,
+                  void (*fn)(void *ctx, const char *word), void *ctx);
+
+#endif
@@ -0,0 +1,636 @@
+// game.c - the command set of the game, shared by the interactive loop and the server
+#include "game.h"
+#include "leaderboard.h"
+#include "constructor.h"
+#include "puzzlepack.h"
+#include "dawg.h"
+#include "puzzle_bank.h"
+#include "workpool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <limits.h>
+
+/* map _stricmp only for MSVC (Visual Studio). On GCC/MinGW prefer POSIX strcasecmp. */
+#if defined(_MSC_VER)
+  #define strcasecmp _stricmp
+  #define strncasecmp _strnicmp
+#else
+  #include <strings.h>
+#endif
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)-1)
+#endif
+
+/* ---------------- Puzzle bank ---------------- */
+
+/* optional puzzle pack: replaces the built-in bank, puzzles are read from
+   the mapping only when they are played */
+static PuzzlePack pack;
+static bool have_pack = false;
+
+bool game_bank_open(const char *pack_path) {
+    if (!pack_path) return PREBUILT_COUNT > 0;
+    have_pack = pp_open(pack_path, &pack) && pp_count(&pack) > 0;
+    if (!have_pack) pp_close(&pack);
+    return have_pack;
+}
+
+void game_bank_close(void) {
+    pp_close(&pack);
+    have_pack = false;
+}
+
+size_t game_bank_count(void) {
+    return have_pack ? pp_count(&pack) : PREBUILT_COUNT;
+}
+
+static const char *bank_title(size_t index) {
+    if (!have_pack) return PREBUILT_TITLES[index % PREBUILT_COUNT];
+    PackPuzzle pz;
+    return pp_get(&pack, index, &pz) ? pz.title : "(damaged puzzle)";
+}
+
+/* Crossword for bank puzzle `index`: built-in puzzles are the shared
+   prebuilt ones from puzzles_gen.c, pack puzzles are loaded from the
+   mapping. */
+static Crossword *make_crossword_from_index(size_t index) {
+    if (have_pack) {
+        PackPuzzle pz;
+        return pp_get(&pack, index, &pz) ? pp_load_crossword(&pz) : NULL;
+    }
+    return &PREBUILT_PUZZLES[index % PREBUILT_COUNT];
+}
+
+/* ---------------- Dictionary ---------------- */
+
+static Dawg dict;
+static bool have_dict = false;
+
+bool game_dict_open(const char *path) {
+    have_dict = dawg_open(path, &dict);
+    return have_dict;
+}
+
+void game_dict_close(void) {
+    dawg_close(&dict);
+    have_dict = false;
+}
+
+/* ---------------- Constructor ---------------- */
+
+static unsigned ctor_threads = 0;
+
+void game_set_ctor_threads(unsigned threads) {
+    ctor_threads = threads;
+}
+
+/* lay a bank puzzle's words out again as a fresh interlocking board */
+static Crossword *generate_from_index(size_t index, unsigned long seed) {
+    CtorOptions opt = { .rows = 15, .cols = 15, .pattern = NULL,
+                        .seed = seed, .max_nodes = 200000,
+                        .threads = ctor_threads ? ctor_threads : workpool_cpu_count() };
+    PackPuzzle pz;
+    const Crossword *src = NULL;
+    size_t count;
+    if (have_pack) {
+        if (!pp_get(&pack, index, &pz)) return NULL;
+        count = pz.word_count;
+    } else {
+        src = &PREBUILT_PUZZLES[index % PREBUILT_COUNT];
+        count = src->word_count;
+    }
+    CtorWord *words = (CtorWord*)malloc((count ? count : 1) * sizeof(CtorWord));
+    if (!words) return NULL;
+    for (size_t i = 0; i < count; ++i) {
+        if (src) {
+            words[i].text = cw_word_text(src, i);
+            words[i].clue = cw_word_clue(src, i);
+        } else {
+            PackWord w;
+            pp_word(&pz, i, &w);
+            words[i].text = w.text;
+            words[i].clue = w.clue;
+        }
+    }
+    Crossword *cw = construct_crossword(words, count, &opt, NULL);
+    free(words);
+    return cw;
+}
+
+/* write every puzzle of the current bank to a pack file */
+static bool export_pack(const char *path) {
+    PackWriter w;
+    if (!pp_writer_open(&w, path)) return false;
+    for (size_t i = 0; i < game_bank_count(); ++i) {
+        if (!have_pack) {
+            (void)pp_writer_add(&w, bank_title(i), &PREBUILT_PUZZLES[i]);
+            continue;
+        }
+        Crossword *cw = make_crossword_from_index(i);
+        if (!cw) continue;
+        (void)pp_writer_add(&w, bank_title(i), cw);
+        destroy_crossword(cw);
+    }
+    return pp_writer_close(&w);
+}
+
+/* ---------------- Leaderboard access ---------------- */
+
+static void (*lb_lock)(void);
+static void (*lb_unlock)(void);
+
+void game_set_lb_lock(void (*lock)(void), void (*unlock)(void)) {
+    lb_lock = lock;
+    lb_unlock = unlock;
+}
+
+static bool locked_lb_add(const char *name, const char *puzzle, int solved, int time_sec,
+                          size_t *rank, size_t *total) {
+    if (lb_lock) lb_lock();
+    lb_refresh();
+    bool ok = lb_add(name, puzzle, solved, time_sec, rank);
+    *total = lb_count();
+    if (lb_unlock) lb_unlock();
+    return ok;
+}
+
+static void locked_lb_render(LBWindow w, const char *puzzle, size_t start, size_t n, FrameBuf *out) {
+    if (lb_lock) lb_lock();
+    lb_refresh();
+    lb_render_view(w, puzzle, start, n == SIZE_MAX ? lb_view_count(w, puzzle) : n, out);
+    if (lb_unlock) lb_unlock();
+}
+
+static void locked_lb_rank(const char *name, FrameBuf *out) {
+    LBPlayerStats st;
+    if (lb_lock) lb_lock();
+    lb_refresh();
+    bool found = lb_player_stats(name, &st);
+    size_t total = lb_count();
+    if (lb_unlock) lb_unlock();
+    if (found)
+        fb_printf(out, "%s is ranked #%zu of %zu (best: %d solved in %ds; %zu play%s, "
+                  "average %.1f solved in %.0fs).\n",
+                  st.best.name, st.rank, total, st.best.solved, st.best.time_sec,
+                  st.plays, st.plays == 1 ? "" : "s", st.avg_solved, st.avg_time_sec);
+    else
+        fb_printf(out, "No leaderboard entries for %s.\n", name);
+}
+
+/* ---------------- Helpers ---------------- */
+
+/* splitmix64: rand() is shared (and locked) process-wide state */
+static uint64_t next_random(Game *g) {
+    uint64_t z = (g->rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static size_t random_below(Game *g, size_t count) {
+    return (size_t)(next_random(g) % count);
+}
+
+static size_t random_index_except(Game *g, size_t except, size_t count) {
+    if (count <= 1) return 0;
+    size_t r;
+    do { r = random_below(g, count); } while (r == except);
+    return r;
+}
+
+/* play `next` with a fresh session; on failure the current puzzle stays */
+static bool switch_puzzle(Game *g, Crossword *next, size_t index) {
+    if (!next) return false;
+    Session *ns = session_create(next);
+    if (!ns) {
+        if (next != g->cw) destroy_crossword(next);
+        return false;
+    }
+    if (next != g->cw) destroy_crossword(g->cw);
+    session_destroy(g->session);
+    g->cw = next;
+    g->session = ns;
+    g->current = index;
+    return true;
+}
+
+/* "[today|week] [puzzle]" after leaderboard: which ranking to show (the
+   puzzle is the one being played); returns the rest of the line */
+static const char *parse_lb_scope(const char *arg, LBWindow *w, bool *this_puzzle) {
+    *w = LB_ALL_TIME;
+    *this_puzzle = false;
+    for (;;) {
+        while (*arg && isspace((unsigned char)*arg)) ++arg;
+        size_t n = strcspn(arg, " \t");
+        if (n == 5 && strncasecmp(arg, "today", 5) == 0) *w = LB_TODAY;
+        else if (n == 4 && strncasecmp(arg, "week", 4) == 0) *w = LB_THIS_WEEK;
+        else if (n == 6 && strncasecmp(arg, "puzzle", 6) == 0) *this_puzzle = true;
+        else return arg;
+        arg += n;
+    }
+}
+
+/* "[N|all|page P]" after leaderboard: first entry and how many to show */
+static size_t parse_lb_arg(const char *arg, size_t default_n, size_t *start) {
+    *start = 0;
+    if (!arg) return default_n;
+    while (*arg && isspace((unsigned char)*arg)) ++arg;
+    if (*arg == '\0') return default_n;
+    if (strcasecmp(arg, "all") == 0) return SIZE_MAX;
+    if (strncasecmp(arg, "page", 4) == 0) {
+        char *endptr = NULL;
+        unsigned long p = strtoul(arg + 4, &endptr, 10);
+        if (endptr != arg + 4 && p > 0 && p <= SIZE_MAX / default_n) *start = (p - 1) * default_n;
+        return default_n;
+    }
+    char *endptr = NULL;
+    long v = strtol(arg, &endptr, 10);
+    if (endptr == arg || v <= 0) return default_n;
+    return (size_t)v;
+}
+
+/* parse "guess <id> <word>" (no strtok: games may run on several threads) */
+static int parse_guess_command(const char *line, size_t *out_id, char *out_word, size_t out_word_len) {
+    const char *p = line + strcspn(line, " \t");        /* skip "guess" */
+    p += strspn(p, " \t");
+    char *endptr = NULL;
+    unsigned long idv = strtoul(p, &endptr, 10);
+    if (endptr == p || (*endptr && !isspace((unsigned char)*endptr))) return 0;
+
+    p = endptr + strspn(endptr, " \t");                 /* word */
+    size_t n = strcspn(p, " \t");
+    if (n == 0) return 0;
+    if (n > out_word_len - 1) n = out_word_len - 1;
+    memcpy(out_word, p, n);
+    out_word[n] = '\0';
+    *out_id = (size_t)idv;
+    return 1;
+}
+
+static void render_banner(const char *title, size_t number, FrameBuf *out) {
+    fb_printf(out, "\n=== Crossword %zu: %s ===\n", number + 1, title);
+    fb_puts(out, "Type 'help' to see commands.\n\n");
+}
+
+static void render_help(const Game *g, FrameBuf *out) {
+    fb_puts(out, "\nCommands:\n");
+    fb_puts(out, "  clues               - list all clues with IDs\n");
+    fb_puts(out, "  guess <id> <WORD>   - answer a clue by its ID\n");
+    fb_puts(out, "  guess <WORD> [...]  - answer without IDs: each word fills every clue it answers\n");
+    fb_puts(out, "  put <r> <c> <L|->   - enter (or clear) one letter; 'show' to see them\n");
+    fb_puts(out, "  show                - show grid (solved letters only)\n");
+    fb_puts(out, "  reveal              - reveal full crossword (answers visible)\n");
+    fb_puts(out, "  graph               - show connectivity (NO answers shown)\n");
+    fb_puts(out, "  next / skip         - load a new random puzzle\n");
+    fb_puts(out, "  words <PATTERN>     - dictionary words matching C?D? ('?' = any letter)\n");
+    if (g->local) {
+        fb_puts(out, "  generate            - build a new interlocking board from a random word set\n");
+        fb_puts(out, "  export <file>       - save the puzzle bank as a pack file\n");
+    }
+    fb_puts(out, "  progress            - show solved %\n");
+    fb_puts(out, "  ansi                - toggle pinned board that redraws only changed cells\n");
+    fb_puts(out, "  leaderboard [N|all] - show top N entries or 'all' (default 10)\n");
+    fb_puts(out, "  leaderboard page P  - show entries 10 at a time\n");
+    fb_puts(out, "  leaderboard today|week|puzzle ... - only today's, this week's or this puzzle's\n");
+    fb_puts(out, "                        entries (combine them: lb week puzzle 5)\n");
+    fb_puts(out, "  lb [N|all|page P]   - shorthand for leaderboard\n");
+    fb_puts(out, "  rank <name>         - a player's best rank, plays and averages\n");
+    fb_puts(out, "  submit <name>       - submit current progress to leaderboard\n");
+    fb_puts(out, "  help                - show this help\n");
+    fb_puts(out, "  quit                - exit\n\n");
+}
+
+/* grid (solved letters only) followed by the progress line */
+static void render_board(Game *g, FrameBuf *out) {
+    if (g->ansi_mode) {
+        ansi_render(&g->ansi, g->cw, g->session, DISPLAY_SOLVED, out);
+        return;
+    }
+    render_crossword(g->cw, g->session, DISPLAY_SOLVED, out);
+    render_progress(g->cw, g->session, out);
+}
+
+void game_present(Game *g, FrameBuf *out) {
+    const char *title = bank_title(g->current);
+    if (g->ansi_mode) {
+        ansi_view_invalidate(&g->ansi);
+        render_board(g, out);
+        render_banner(title, g->current, out);
+        render_clues(g->cw, g->session, out);
+        return;
+    }
+    render_banner(title, g->current, out);
+    render_crossword(g->cw, g->session, DISPLAY_SOLVED, out);
+    render_clues(g->cw, g->session, out);
+    render_progress(g->cw, g->session, out);
+}
+
+/* ---------------- Lifecycle ---------------- */
+
+bool game_init(Game *g, bool local, unsigned long seed) {
+    memset(g, 0, sizeof *g);
+    g->local = local;
+    g->rng = (uint64_t)seed;
+    ansi_view_init(&g->ansi);
+    size_t count = game_bank_count();
+    if (count == 0) return false;
+    size_t pick = random_below(g, count);
+    return switch_puzzle(g, make_crossword_from_index(pick), pick);
+}
+
+void game_free(Game *g) {
+    session_destroy(g->session);
+    destroy_crossword(g->cw);
+    ansi_view_free(&g->ansi);
+    g->session = NULL;
+    g->cw = NULL;
+}
+
+void game_prompt(const Game *g, FrameBuf *out) {
+    if (!g->awaiting_name) fb_puts(out, "\n> ");
+}
+
+void game_finish(Game *g, FrameBuf *out) {
+    ansi_release(&g->ansi, out);
+}
+
+/* ---------------- Commands ---------------- */
+
+static void load_next(Game *g, FrameBuf *out) {
+    size_t pick = random_index_except(g, g->current, game_bank_count());
+    if (!switch_puzzle(g, make_crossword_from_index(pick), pick)) {
+        fb_printf(out, "Could not load puzzle %zu.\n", pick + 1);
+        return;
+    }
+    game_present(g, out);
+}
+
+/* leaderboard records are comma-separated: a name may not hold one */
+static bool lb_name_ok(const char *name, FrameBuf *out) {
+    if (!strchr(name, ',')) return true;
+    fb_puts(out, "Names cannot contain ','.\n");
+    return false;
+}
+
+/* the line after a completed puzzle: record it under that name, move on */
+static void finish_with_name(Game *g, const char *line, FrameBuf *out) {
+    char name[LB_NAME_LEN];
+    size_t n = strlen(line);
+    if (n > sizeof name - 1) n = sizeof name - 1;
+    memcpy(name, line, n);
+    name[n] = '\0';
+    if (!lb_name_ok(name, out)) {
+        fb_puts(out, "Enter your name to record on leaderboard (or press Enter to skip): ");
+        return;
+    }
+    g->awaiting_name = false;
+    if (name[0] != '\0') {
+        size_t rank, total;
+        if (locked_lb_add(name, bank_title(g->current), (int)g->cw->word_count, g->finish_sec,
+                          &rank, &total)) {
+            fb_printf(out, "Recorded on leaderboard at #%zu of %zu. Congratulations, %s!\n", rank, total, name);
+        } else {
+            fb_puts(out, "Could not record on leaderboard.\n");
+        }
+    } else {
+        fb_puts(out, "Skipped recording.\n");
+    }
+    load_next(g, out);
+}
+
+/* after a move: once every word is solved, stop the clock and ask for a name */
+static void check_complete(Game *g, FrameBuf *out) {
+    if (!is_puzzle_complete(g->cw, g->session)) return;
+    fb_puts(out, "\n🎉 Puzzle complete!\n");
+    render_solution(g->cw, out);
+    /* the clock stops here, not when the name arrives */
+    g->finish_sec = (int)difftime(time(NULL), g->session->started);
+    fb_puts(out, "Enter your name to record on leaderboard (or press Enter to skip): ");
+    g->awaiting_name = true;
+}
+
+/* one word of "guess <WORD> [WORD...]": every clue it answers */
+static void guess_any(Game *g, const char *word, FrameBuf *out) {
+    size_t first;
+    bool matched;
+    size_t n = make_guess_any(g->cw, g->session, word, &first, 1, &matched);
+    if (n == 1)
+        fb_printf(out, "✅ Correct! Revealed \"%s\" on the grid.\n", cw_word_text(g->cw, first));
+    else if (n > 1)
+        fb_printf(out, "✅ Correct! Revealed \"%s\" on the grid (%zu clues).\n", cw_word_text(g->cw, first), n);
+    else if (matched)
+        fb_printf(out, "\"%s\" is already solved.\n", word);
+    else
+        fb_printf(out, "❌ \"%s\" is incorrect.\n", word);
+}
+
+static void do_guess(Game *g, const char *line, FrameBuf *out) {
+    size_t id;
+    char word[128];
+    const char *p = line + strcspn(line, " \t");       /* skip "guess" */
+    p += strspn(p, " \t");
+    if (isdigit((unsigned char)*p)) {
+        if (!parse_guess_command(line, &id, word, sizeof word)) {
+            fb_puts(out, "Usage: guess <id> <WORD> | guess <WORD> [WORD...]\n");
+            return;
+        }
+        if (id >= g->cw->word_count) {
+            fb_puts(out, "Invalid clue id. Use 'clues' to see IDs.\n");
+            return;
+        }
+        if (make_guess(g->cw, g->session, word, id)) {
+            fb_printf(out, "✅ Correct! Revealed \"%s\" on the grid.\n", cw_word_text(g->cw, id));
+        } else {
+            fb_puts(out, "❌ Incorrect. Keep trying.\n");
+        }
+    } else {
+        /* no id: each word is looked up among the answers */
+        if (!*p) {
+            fb_puts(out, "Usage: guess <id> <WORD> | guess <WORD> [WORD...]\n");
+            return;
+        }
+        while (*p) {
+            size_t n = strcspn(p, " \t");
+            if (n > sizeof word - 1) n = sizeof word - 1;
+            memcpy(word, p, n);
+            word[n] = '\0';
+            guess_any(g, word, out);
+            p += strcspn(p, " \t");
+            p += strspn(p, " \t");
+        }
+    }
+    render_board(g, out);
+    check_complete(g, out);
+}
+
+/* "put <row> <col> <LETTER>" ('-' or nothing clears the cell). A letter
+   that completes no word gets no reply beyond the ANSI board's changed
+   cells, so typing stays cheap. */
+static void do_put(Game *g, const char *line, FrameBuf *out) {
+    char *endptr = NULL;
+    const char *p = line + 3;
+    unsigned long r = strtoul(p, &endptr, 10);
+    if (endptr == p) { fb_puts(out, "Usage: put <row> <col> <LETTER|->\n"); return; }
+    p = endptr;
+    unsigned long c = strtoul(p, &endptr, 10);
+    if (endptr == p) { fb_puts(out, "Usage: put <row> <col> <LETTER|->\n"); return; }
+    p = endptr + strspn(endptr, " \t");
+    char letter = *p == '\0' || *p == '-' ? ' ' : *p;
+    if (*p && p[1] && !isspace((unsigned char)p[1])) { fb_puts(out, "Usage: put <row> <col> <LETTER|->\n"); return; }
+
+    size_t done[2], ndone;
+    if (!enter_letter(g->cw, g->session, r, c, letter, done, &ndone)) {
+        if (r < g->cw->rows && c < g->cw->cols && CW_CELL(g->cw, r, c) != '.' &&
+            session_cell_revealed(g->cw, g->session, r, c))
+            fb_puts(out, "That cell is already solved.\n");
+        else
+            fb_puts(out, "No letter cell there, or not a letter.\n");
+        return;
+    }
+    for (size_t i = 0; i < ndone; ++i)
+        fb_printf(out, "✅ Correct! Completed \"%s\".\n", cw_word_text(g->cw, done[i]));
+    if (ndone == 0) {
+        if (g->ansi_mode) render_board(g, out);
+        return;
+    }
+    render_board(g, out);
+    check_complete(g, out);
+}
+
+#define WORDS_SHOWN 50
+
+typedef struct {
+    FrameBuf *out;
+    size_t shown;
+} WordsCtx;
+
+static void list_word(void *ctx, const char *word) {
+    WordsCtx *w = (WordsCtx*)ctx;
+    if (w->shown == WORDS_SHOWN) return;
+    fb_printf(w->out, "%s%s", w->shown % 10 ? " " : "\n  ", word);
+    ++w->shown;
+}
+
+/* "words <PATTERN>": dictionary words that fit, '?' for an unknown letter */
+static void do_words(const char *line, FrameBuf *out) {
+    const char *pattern = line + 5;
+    pattern += strspn(pattern, " \t");
+    if (!have_dict) { fb_puts(out, "No dictionary loaded (start with --dict <file>).\n"); return; }
+    if (!*pattern || strcspn(pattern, " \t") != strlen(pattern) || strlen(pattern) >= MAX_WORD_LEN) {
+        fb_puts(out, "Usage: words <PATTERN>, e.g. words C?D?\n");
+        return;
+    }
+    WordsCtx w = { out, 0 };
+    size_t n = dawg_match(&dict, pattern, list_word, &w);
+    if (w.shown) fb_putc(out, '\n');
+    if (n > w.shown) fb_printf(out, "%zu words match (first %zu shown).\n", n, w.shown);
+    else fb_printf(out, "%zu word%s match%s.\n", n, n == 1 ? "" : "s", n == 1 ? "es" : "");
+}
+
+static void do_graph(const Game *g, FrameBuf *out) {
+    Graph *gr = build_crossword_graph(g->cw);
+    if (!gr) { fb_puts(out, "Out of memory.\n"); return; }
+    fb_printf(out, "\nGraph connectivity: %s\n",
+              is_crossword_connected(gr) ? "✅ All words connected" : "⚠️ Not fully connected");
+    fb_printf(out, "Components: %zu\n", crossword_component_count(g->cw));
+    for (size_t i = 0; i < gr->num_vertices; ++i) {
+        size_t deg = gr->offsets[i + 1] - gr->offsets[i];
+        fb_printf(out, "Node %zu: degree=%zu neighbors:", i, deg);
+        for (size_t k = gr->offsets[i]; k < gr->offsets[i + 1]; ++k) fb_printf(out, " %zu", gr->nbr[k]);
+        fb_putc(out, '\n');
+    }
+    free_graph(gr);
+}
+
+bool game_command(Game *g, const char *line, FrameBuf *out) {
+    if (g->awaiting_name) { finish_with_name(g, line, out); return true; }
+
+    if (strcmp(line, "quit") == 0) return false;
+    if (strcmp(line, "help") == 0) { render_help(g, out); return true; }
+    if (strcmp(line, "show") == 0) {
+        if (g->ansi_mode) { ansi_view_invalidate(&g->ansi); render_board(g, out); }
+        else render_crossword(g->cw, g->session, DISPLAY_SOLVED, out);
+        return true;
+    }
+    if (strcmp(line, "ansi") == 0) {
+        g->ansi_mode = !g->ansi_mode;
+        if (g->ansi_mode) { ansi_view_invalidate(&g->ansi); render_board(g, out); }
+        else ansi_release(&g->ansi, out);
+        fb_printf(out, "ANSI redraw %s.\n", g->ansi_mode ? "on" : "off");
+        return true;
+    }
+    if (strcmp(line, "reveal") == 0) { render_solution(g->cw, out); return true; }
+    if (strcmp(line, "clues") == 0) { render_clues(g->cw, g->session, out); return true; }
+    if (strcmp(line, "progress") == 0) { render_progress(g->cw, g->session, out); return true; }
+
+    if (strncmp(line, "leaderboard", 11) == 0 || strncmp(line, "lb", 2) == 0) {
+        const char *arg = strncmp(line, "leaderboard", 11) == 0 ? line + 11 : line + 2;
+        LBWindow w;
+        bool this_puzzle;
+        arg = parse_lb_scope(arg, &w, &this_puzzle);
+        size_t start, n = parse_lb_arg(arg, 10, &start);
+        locked_lb_render(w, this_puzzle ? bank_title(g->current) : NULL, start, n, out);
+        return true;
+    }
+
+    if (strncmp(line, "rank ", 5) == 0) {
+        char name[LB_NAME_LEN];
+        if (sscanf(line + 5, "%31s", name) >= 1) locked_lb_rank(name, out);
+        else fb_puts(out, "Usage: rank <name>\n");
+        return true;
+    }
+
+    if (strncmp(line, "submit ", 7) == 0) {
+        char name[LB_NAME_LEN];
+        if (sscanf(line + 7, "%31s", name) >= 1) {
+            if (!lb_name_ok(name, out)) return true;
+            int solved = (int)g->session->solved_count;
+            int tsec = (int)difftime(time(NULL), g->session->started);
+            size_t rank, total;
+            if (locked_lb_add(name, bank_title(g->current), solved, tsec, &rank, &total))
+                fb_printf(out, "Submitted to leaderboard (#%zu of %zu).\n", rank, total);
+            else fb_puts(out, "Could not submit to leaderboard.\n");
+        } else {
+            fb_puts(out, "Usage: submit <name>\n");
+        }
+        return true;
+    }
+
+    if (strcmp(line, "graph") == 0) { do_graph(g, out); return true; }
+    if (strncmp(line, "words", 5) == 0 && (line[5] == '\0' || isspace((unsigned char)line[5]))) {
+        do_words(line, out);
+        return true;
+    }
+
+    if (strcmp(line, "generate") == 0 || strncmp(line, "export ", 7) == 0) {
+        if (!g->local) { fb_puts(out, "Not available in this mode.\n"); return true; }
+        if (line[0] == 'g') {
+            size_t pick = random_below(g, game_bank_count());
+            Crossword *gen = generate_from_index(pick, (unsigned long)next_random(g));
+            if (!switch_puzzle(g, gen, pick)) {
+                fb_puts(out, "Could not generate a board from that word set. Try again.\n");
+                return true;
+            }
+            game_present(g, out);
+            return true;
+        }
+        const char *path = line + 7;
+        while (isspace((unsigned char)*path)) ++path;
+        if (*path && export_pack(path)) fb_printf(out, "Wrote %zu puzzles to %s.\n", game_bank_count(), path);
+        else fb_puts(out, "Usage: export <file> (could not write pack)\n");
+        return true;
+    }
+
+    if (strcmp(line, "next") == 0 || strcmp(line, "skip") == 0) { load_next(g, out); return true; }
+
+    if (strncmp(line, "guess", 5) == 0) { do_guess(g, line, out); return true; }
+    if (strncmp(line, "put ", 4) == 0) { do_put(g, line, out); return true; }
+
+    fb_puts(out, "Unrecognized command. Type 'help' for options.\n");
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "crossword.h"
+#include "render.h"
+
+/* One player's game: the puzzle being played, their session on it and
+   their terminal settings. The command loop (stdin in main.c, a socket
+   per client in server.c) feeds it lines and writes out what it appends
+   to a FrameBuf; nothing here reads input or prints directly. */
+typedef struct {
+    Crossword *cw;          // current puzzle (prebuilt ones are shared)
+    Session   *session;
+    size_t     current;     // bank index of cw
+    bool       local;       // may write files and run the constructor
+    bool       awaiting_name;   // puzzle finished: the next line is a leaderboard name
+    int        finish_sec;  // solve time of the finished puzzle
+    bool       ansi_mode;
+    AnsiView   ansi;
+    uint64_t   rng;         // per-game random state
+} Game;
+
+/* The puzzle bank shared by every game: the prebuilt puzzles, or a
+   puzzle pack when pack_path is not NULL. */
+bool game_bank_open(const char *pack_path);
+void game_bank_close(void);
+size_t game_bank_count(void);
+
+/* Optional dictionary for the "words" command: a DAWG image written by
+   --build-dict, mapped read-only and shared by every game. */
+bool game_dict_open(const char *path);
+void game_dict_close(void);
+
+/* Worker threads for the constructor behind "generate" (0 = one per
+   online CPU, 1 = sequential search). */
+void game_set_ctor_threads(unsigned threads);
+
+/* Leaderboard calls made by game_command are bracketed by these when set
+   (the multi-loop server shares one leaderboard between threads). */
+void game_set_lb_lock(void (*lock)(void), void (*unlock)(void));
+
+/* Start on a random bank puzzle; false if none could be loaded */
+bool game_init(Game *g, bool local, unsigned long seed);
+void game_free(Game *g);
+
+/* banner, board and clues of the current puzzle */
+void game_present(Game *g, FrameBuf *out);
+/* prompt for the next line ("> ", or nothing while asking for a name) */
+void game_prompt(const Game *g, FrameBuf *out);
+/* run one input line (no newline); false once the player quits */
+bool game_command(Game *g, const char *line, FrameBuf *out);
+/* hand the terminal back (leaves ANSI mode) */
+void game_finish(Game *g, FrameBuf *out);
+
+#endif
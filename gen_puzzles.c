@@ -0,0 +1,175 @@
+// gen_puzzles.c - build tool: places every puzzle of the source bank and
+// writes the finished crosswords out as static C tables (puzzles_gen.c).
+//
+//   gcc -std=c11 -Wall -Wextra gen_puzzles.c puzzle_bank.c crossword.c render.c -o gen_puzzles
+//   ./gen_puzzles puzzles_gen.c
+//
+// A word that does not fit or clashes with another is reported here and
+// the tool exits non-zero, so a broken bank never reaches the game build.
+#include "puzzle_bank.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* C string literal for s, escaping what needs it */
+static void put_literal(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20 || c == 0x7F) fprintf(out, "\\%03o", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static void put_owner(FILE *out, size_t v) {
+    if (v == CW_NO_WORD) fputs("CW_NO_WORD", out);
+    else fprintf(out, "%zu", v);
+}
+
+/* one puzzle's arrays, all named with suffix i */
+static void emit_tables(FILE *out, size_t i, Crossword *cw) {
+    size_t ncells = cw->rows * cw->cols;
+
+    fprintf(out, "static char cells_%zu[%zu] =\n", i, ncells);
+    for (size_t r = 0; r < cw->rows; ++r) {
+        fprintf(out, "    \"%.*s\"%s\n", (int)cw->cols, &CW_CELL(cw, r, 0), r + 1 == cw->rows ? ";" : "");
+    }
+
+    fprintf(out, "static size_t owner_%zu[%zu] = {", i, ncells * 2);
+    for (size_t k = 0; k < ncells * 2; ++k) {
+        fputs(k % 8 == 0 ? "\n    " : " ", out);
+        put_owner(out, cw->owner[k]);
+        fputc(',', out);
+    }
+    fputs("\n};\n", out);
+
+    /* word arrays, then the string pool one answer + clue per line */
+    static const char *const names[4] = { "row", "col", "len", "dir" };
+    for (int f = 0; f < 4; ++f) {
+        fprintf(out, "static %s %s_%zu[%zu] = {", f < 2 ? "uint32_t" : "uint8_t",
+                names[f], i, cw->word_count);
+        for (size_t k = 0; k < cw->word_count; ++k) {
+            unsigned long v = f == 0 ? cw->word_row[k] : f == 1 ? cw->word_col[k]
+                            : f == 2 ? cw->word_len[k] : cw->word_dir[k];
+            fprintf(out, "%s%lu,", k % 16 == 0 ? "\n    " : " ", v);
+        }
+        fputs("\n};\n", out);
+    }
+    fprintf(out, "static size_t text_%zu[%zu] = {", i, cw->word_count);
+    for (size_t k = 0; k < cw->word_count; ++k)
+        fprintf(out, "%s%zu,", k % 16 == 0 ? "\n    " : " ", cw->word_text[k]);
+    fprintf(out, "\n};\nstatic size_t clue_%zu[%zu] = {", i, cw->word_count);
+    for (size_t k = 0; k < cw->word_count; ++k)
+        fprintf(out, "%s%zu,", k % 16 == 0 ? "\n    " : " ", cw->word_clue[k]);
+    fputs("\n};\n", out);
+    /* sized exactly, so the literal's own terminator is dropped */
+    fprintf(out, "static char pool_%zu[%zu] =", i, cw->pool_len);
+    for (size_t k = 0; k < cw->word_count; ++k) {
+        fputs("\n    ", out);
+        put_literal(out, cw_word_text(cw, k));
+        fputs(" \"\\000\" ", out);
+        put_literal(out, cw_word_clue(cw, k));
+        fputs(" \"\\000\"", out);
+    }
+    fputs(";\n", out);
+
+    /* union-find stored fully compressed: every parent is its root */
+    fprintf(out, "static size_t parent_%zu[%zu] = {", i, cw->word_count);
+    for (size_t k = 0; k < cw->word_count; ++k)
+        fprintf(out, "%s%zu,", k % 16 == 0 ? "\n    " : " ", crossword_find_component(cw, k));
+    fputs("\n};\n", out);
+    fprintf(out, "static unsigned char rank_%zu[%zu] = {", i, cw->word_count);
+    for (size_t k = 0; k < cw->word_count; ++k)
+        fprintf(out, "%s%u,", k % 16 == 0 ? "\n    " : " ", (unsigned)cw->dsu_rank[k]);
+    fputs("\n};\n", out);
+
+    /* answer index as built, so lookups need no setup */
+    fprintf(out, "static size_t answer_slot_%zu[%zu] = {", i, cw->answer_cap);
+    for (size_t k = 0; k < cw->answer_cap; ++k) {
+        fputs(k % 8 == 0 ? "\n    " : " ", out);
+        put_owner(out, cw->answer_slot[k]);
+        fputc(',', out);
+    }
+    fprintf(out, "\n};\nstatic size_t answer_next_%zu[%zu] = {", i, cw->word_count);
+    for (size_t k = 0; k < cw->word_count; ++k) {
+        fputs(k % 8 == 0 ? "\n    " : " ", out);
+        put_owner(out, cw->answer_next[k]);
+        fputc(',', out);
+    }
+    fputs("\n};\n\n", out);
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : NULL;
+    FILE *out = path ? fopen(path, "w") : stdout;
+    if (!out) { perror(path); return 1; }
+
+    Crossword **built = (Crossword**)calloc(PUZZLE_COUNT ? PUZZLE_COUNT : 1, sizeof(Crossword*));
+    if (!built) { fputs("gen_puzzles: out of memory\n", stderr); return 1; }
+    int errors = 0;
+    for (size_t i = 0; i < PUZZLE_COUNT; ++i) {
+        const Puzzle *pz = &PUZZLES[i];
+        if (pz->count == 0) {
+            fprintf(stderr, "gen_puzzles: puzzle %zu \"%s\" has no words\n", i + 1, pz->title);
+            ++errors;
+            continue;
+        }
+        built[i] = create_crossword(pz->rows, pz->cols);
+        if (!built[i]) { fputs("gen_puzzles: out of memory\n", stderr); return 1; }
+        for (size_t k = 0; k < pz->count; ++k) {
+            const Entry *e = &pz->entries[k];
+            if (!add_word(built[i], e->text, e->row, e->col, e->dir, e->clue)) {
+                fprintf(stderr, "gen_puzzles: puzzle %zu \"%s\": %s at (%zu,%zu) %s does not fit\n",
+                        i + 1, pz->title, e->text, e->row, e->col,
+                        e->dir == DIR_ACROSS ? "ACROSS" : "DOWN");
+                ++errors;
+            }
+        }
+    }
+
+    if (!errors) {
+        fputs("/* Generated by gen_puzzles from puzzle_bank.c. Do not edit. */\n"
+              "#include \"puzzle_bank.h\"\n\n", out);
+        for (size_t i = 0; i < PUZZLE_COUNT; ++i) emit_tables(out, i, built[i]);
+
+        fputs("Crossword PREBUILT_PUZZLES[] = {\n", out);
+        for (size_t i = 0; i < PUZZLE_COUNT; ++i) {
+            const Crossword *cw = built[i];
+            fprintf(out,
+                    "    { .rows = %zu, .cols = %zu, .cells = cells_%zu,\n"
+                    "      .word_count = %zu, .word_cap = %zu,\n"
+                    "      .word_row = row_%zu, .word_col = col_%zu,\n"
+                    "      .word_len = len_%zu, .word_dir = dir_%zu,\n"
+                    "      .word_text = text_%zu, .word_clue = clue_%zu,\n"
+                    "      .pool = pool_%zu, .pool_len = %zu, .pool_cap = %zu,\n"
+                    "      .owner = owner_%zu,\n"
+                    "      .dsu_parent = parent_%zu, .dsu_rank = rank_%zu,\n"
+                    "      .components = %zu,\n"
+                    "      .answer_slot = answer_slot_%zu, .answer_cap = %zu, .answer_next = answer_next_%zu,\n"
+                    "      .prebuilt = true },\n",
+                    cw->rows, cw->cols, i, cw->word_count, cw->word_count,
+                    i, i, i, i, i, i, i, cw->pool_len, cw->pool_len,
+                    i, i, i, cw->components, i, cw->answer_cap, i);
+        }
+        fputs("};\n\nconst char *const PREBUILT_TITLES[] = {\n", out);
+        for (size_t i = 0; i < PUZZLE_COUNT; ++i) {
+            fputs("    ", out);
+            put_literal(out, PUZZLES[i].title);
+            fputs(",\n", out);
+        }
+        fprintf(out, "};\n\nconst size_t PREBUILT_COUNT = %zu;\n", PUZZLE_COUNT);
+    }
+
+    for (size_t i = 0; i < PUZZLE_COUNT; ++i) destroy_crossword(built[i]);
+    free(built);
+    bool write_failed = ferror(out) != 0;
+    if (path && fclose(out) != 0) write_failed = true;
+    if (errors || write_failed) {
+        if (path) remove(path);
+        if (write_failed) fputs("gen_puzzles: could not write output\n", stderr);
+        return 1;
+    }
+    return 0;
+}
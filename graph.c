@@ -4,74 +4,106 @@
 #include <string.h>
 #include <stdbool.h>
 
-/* Returns true if words a and b overlap on at least one grid cell */
-static bool words_intersect(const Crossword *cw, const Word *a, const Word *b) {
-    size_t lenA = strlen(a->text);
-    size_t lenB = strlen(b->text);
-    for (size_t i = 0; i < lenA; ++i) {
-        size_t ra = a->row + (a->dir == DIR_DOWN ? i : 0);
-        size_t ca = a->col + (a->dir == DIR_ACROSS ? i : 0);
-        for (size_t j = 0; j < lenB; ++j) {
-            size_t rb = b->row + (b->dir == DIR_DOWN ? j : 0);
-            size_t cb = b->col + (b->dir == DIR_ACROSS ? j : 0);
-            if (ra == rb && ca == cb && cw->cells[ra][ca] != '.') return true;
+/* Calls visit(ctx, i, j) once for every crossing between across word i and
+   down word j, using the cell ownership index. */
+static void for_each_crossing(const Crossword *cw,
+                              void (*visit)(void *ctx, size_t i, size_t j), void *ctx)
+{
+    for (size_t i = 0; i < cw->word_count; ++i) {
+        if (cw->word_dir[i] != DIR_ACROSS) continue;
+        size_t row = cw->word_row[i], col = cw->word_col[i];
+        for (size_t k = 0; k < cw->word_len[i]; ++k) {
+            size_t j = CW_OWNER(cw, row, col + k, DIR_DOWN);
+            if (j != CW_NO_WORD) visit(ctx, i, j);
         }
     }
-    return false;
 }
 
-static GraphNode *new_node(size_t idx) {
-    GraphNode *n = (GraphNode*)malloc(sizeof(GraphNode));
-    if (!n) return NULL;
-    n->index = idx; n->next = NULL;
-    return n;
+static void count_edge(void *ctx, size_t i, size_t j) {
+    (void)i; (void)j;
+    ++*(size_t*)ctx;
+}
+
+static void count_degree(void *ctx, size_t i, size_t j) {
+    Graph *g = (Graph*)ctx;
+    ++g->offsets[i];
+    ++g->offsets[j];
+}
+
+static void fill_edge(void *ctx, size_t i, size_t j) {
+    Graph *g = (Graph*)ctx;
+    g->nbr[g->offsets[i]++] = j;
+    g->nbr[g->offsets[j]++] = i;
 }
 
 Graph *build_crossword_graph(const Crossword *cw) {
-    Graph *g = (Graph*)calloc(1, sizeof(Graph));
+    size_t crossings = 0;
+    for_each_crossing(cw, count_edge, &crossings);
+
+    size_t nv = cw->word_count;
+    size_t nslots = (nv + 1) + 2 * crossings;
+    Graph *g = (Graph*)malloc(sizeof(Graph) + nslots * sizeof(size_t));
     if (!g) return NULL;
-    g->num_vertices = cw->word_count;
-    for (size_t i = 0; i < cw->word_count; ++i) g->adj[i] = NULL;
+    g->num_vertices = nv;
+    g->num_edges = 2 * crossings;
+    g->offsets = (size_t*)(g + 1);
+    g->nbr = g->offsets + (nv + 1);
+    memset(g->offsets, 0, (nv + 1) * sizeof(size_t));
 
-    for (size_t i = 0; i < cw->word_count; ++i) {
-        for (size_t j = i + 1; j < cw->word_count; ++j) {
-            if (words_intersect(cw, &cw->words[i], &cw->words[j])) {
-                GraphNode *n1 = new_node(j);
-                if (n1) { n1->next = g->adj[i]; g->adj[i] = n1; }
-                GraphNode *n2 = new_node(i);
-                if (n2) { n2->next = g->adj[j]; g->adj[j] = n2; }
-            }
-        }
+    /* degrees -> start offsets */
+    for_each_crossing(cw, count_degree, g);
+    size_t sum = 0;
+    for (size_t i = 0; i < nv; ++i) {
+        size_t deg = g->offsets[i];
+        g->offsets[i] = sum;
+        sum += deg;
     }
+    /* fill, advancing each start to the end of its row, then shift back */
+    for_each_crossing(cw, fill_edge, g);
+    for (size_t i = nv; i > 0; --i) g->offsets[i] = g->offsets[i - 1];
+    g->offsets[0] = 0;
     return g;
 }
 
 void free_graph(Graph *g) {
-    if (!g) return;
-    for (size_t i = 0; i < g->num_vertices; ++i) {
-        GraphNode *cur = g->adj[i];
-        while (cur) {
-            GraphNode *tmp = cur->next;
-            free(cur);
-            cur = tmp;
-        }
-    }
     free(g);
 }
 
 void dfs_graph(const Graph *g, size_t start, bool visited[]) {
     if (!g || start >= g->num_vertices) return;
     visited[start] = true;
-    for (GraphNode *n = g->adj[start]; n; n = n->next) {
-        if (!visited[n->index]) dfs_graph(g, n->index, visited);
+    for (size_t k = g->offsets[start]; k < g->offsets[start + 1]; ++k) {
+        if (!visited[g->nbr[k]]) dfs_graph(g, g->nbr[k], visited);
+    }
+}
+
+/* Same traversal as dfs_graph but with an explicit stack, so deep boards
+   cannot overflow the call stack. Returns false if the stack can't be allocated. */
+bool dfs_graph_iterative(const Graph *g, size_t start, bool visited[]) {
+    if (!g || start >= g->num_vertices) return true;
+    size_t *stack = (size_t*)malloc(g->num_vertices * sizeof(size_t));
+    if (!stack) return false;
+    size_t top = 0;
+    visited[start] = true;
+    stack[top++] = start;
+    while (top) {
+        size_t v = stack[--top];
+        for (size_t k = g->offsets[v]; k < g->offsets[v + 1]; ++k) {
+            size_t u = g->nbr[k];
+            if (!visited[u]) { visited[u] = true; stack[top++] = u; }
+        }
     }
+    free(stack);
+    return true;
 }
 
 bool is_crossword_connected(const Graph *g) {
     if (!g) return true;
     if (g->num_vertices == 0) return true;
-    bool visited[MAX_WORDS] = {0};
-    dfs_graph(g, 0, visited);
-    for (size_t i = 0; i < g->num_vertices; ++i) if (!visited[i]) return false;
-    return true;
+    bool *visited = (bool*)calloc(g->num_vertices, sizeof(bool));
+    if (!visited) return false;
+    bool connected = dfs_graph_iterative(g, 0, visited);
+    for (size_t i = 0; connected && i < g->num_vertices; ++i) if (!visited[i]) connected = false;
+    free(visited);
+    return connected;
 }
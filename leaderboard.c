@@ -1,12 +1,123 @@
 // leaderboard.c (robust CSV parsing, no sscanf warnings)
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE     /* flock */
+#endif
 #include "leaderboard.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
-static LBEntry lb_store[LB_MAX_ENTRIES];
+/* The writer thread uses pthreads (also provided by MinGW); with
+   -DLB_NO_THREADS, async persistence falls back to synchronous writes. */
+#if defined(_MSC_VER) && !defined(LB_NO_THREADS)
+#define LB_NO_THREADS
+#endif
+
+#ifndef LB_NO_THREADS
+#include <pthread.h>
+#endif
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* Every entry ever accepted, in acceptance order, in fixed-size chunks
+   that never move once allocated. An AVL tree over the same slot numbers,
+   with subtree sizes, keeps them in lb_cmp order: insert, rank and
+   "k-th best" are all O(log n). Views (per puzzle, per day or week) are
+   more such trees over the same slots. A name index keeps each player's
+   best entry and running totals. */
+#define LB_CHUNK 4096
+#define LB_NIL UINT32_MAX
+#define LB_MAX_DEPTH 64     /* AVL height bound for 2^32 nodes is ~46 */
+
+static LBEntry **lb_chunks = NULL;  /* chunk directory */
+static size_t lb_chunk_cap = 0;
 static size_t lb_used = 0;
+typedef struct {
+    int32_t  solved, time_sec;  /* sort key, copied from the entry so a */
+    int64_t  when;              /* descent never touches the chunks */
+    uint32_t left, right;       /* node numbers, LB_NIL for none */
+    uint32_t size;              /* nodes in this subtree */
+    uint32_t height;
+} LBNode;
+
+/* An order-statistic tree: node k stands for slot slot[k], or for slot k
+   itself when slot is NULL (the main tree, over every entry). */
+typedef struct {
+    LBNode   *node;
+    uint32_t *slot;
+    size_t    n, cap;
+    uint32_t  root;
+} LBTree;
+
+static LBTree lb_all = { NULL, NULL, 0, 0, LB_NIL };
+
+typedef struct {
+    uint32_t best;              /* slot of their best entry; LB_NIL: free cell */
+    uint32_t plays;
+    int64_t  sum_solved, sum_time;
+} LBPlayer;
+
+static LBPlayer *lb_names = NULL;   /* open addressing on name */
+static size_t lb_names_cap = 0, lb_names_used = 0;
+
+/* A binary snapshot is loaded by mapping it: its first lb_map_chunks
+   chunks are read in place and are not freed with the table. */
+typedef struct {
+    void  *base;                /* the mapping, or a heap copy of the file */
+    size_t len;
+    bool   mapped;
+} LBMap;
+
+static LBMap lb_map;
+static size_t lb_map_chunks = 0;
+static size_t lb_sorted_len = 0;    /* slots below this are in rank order */
+
+#define LB_AT(i) (&lb_chunks[(i) / LB_CHUNK][(i) % LB_CHUNK])
+
+/* persistence state; with the writer running, everything below plus
+   lb_used and lb_chunks are guarded by lb_mutex. The writer reads entries
+   only through its own copy of the chunk directory: slots below the
+   count it copied never change. */
+static LBPersistOptions lb_opt = { false, LB_DURABLE_EACH, 1000, false, 1024, false, false };
+static bool lb_dirty = false;       /* CSV: table changed since the last write;
+                                       journal: a record was lost, compact */
+static LBEntry *lb_pending = NULL;  /* journal: accepted, not yet appended */
+static size_t lb_pending_len = 0, lb_pending_cap = 0;
+static const LBEntry *lb_inflight = NULL;   /* shared: being written by the writer */
+static size_t lb_inflight_len = 0;
+static size_t lb_journal_records = 0;   /* appended since the last snapshot
+                                           (shared: read back from the journal) */
+static uint64_t lb_journal_gen = 0;
+static FILE *lb_journal = NULL;
+static long lb_seen_off = 0;        /* shared: how far the followed file has been read */
+static LBEntry *lb_unseen = NULL;   /* shared: ours, written but not yet read back */
+static size_t lb_unseen_len = 0, lb_unseen_cap = 0;
+static bool lb_unseen_lost = false; /* could not note one: reload instead */
+#define LB_ANY_GEN UINT64_MAX
+static uint64_t lb_snapshot_folded = LB_ANY_GEN;   /* journal gen the loaded snapshot holds */
+static bool lb_unsynced = false;    /* last write not yet forced to disk */
+static uint64_t lb_last_sync = 0;   /* ms, lb_now_ms clock */
+#ifndef LB_NO_THREADS
+static pthread_mutex_t lb_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lb_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t lb_writer;
+static bool lb_writer_running = false;
+static bool lb_stopping = false;
+#endif
 
 /* comparator: return negative if A should appear before B (A better) */
 static int lb_cmp(const void *pa, const void *pb) {
@@ -19,104 +130,1630 @@ static int lb_cmp(const void *pa, const void *pb) {
     return 0;
 }
 
-void lb_init(void) {
-    lb_used = 0;
-    FILE *f = fopen(LB_FILE, "r");
-    if (!f) return;
+/* FNV-1a: the name index, and telling a complete journal record from a torn one */
+static uint32_t lb_hash(const char *s, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) { h ^= (unsigned char)s[i]; h *= 16777619u; }
+    return h;
+}
+
+/* ---------------- Ordered index ---------------- */
+
+/* lb_cmp between the key held in a node and an entry */
+static int lb_node_cmp(const LBNode *n, const LBEntry *e) {
+    if (n->solved != e->solved) return n->solved > e->solved ? -1 : 1;
+    if (n->time_sec != e->time_sec) return n->time_sec < e->time_sec ? -1 : 1;
+    if (n->when != (int64_t)e->when) return n->when < (int64_t)e->when ? -1 : 1;
+    return 0;
+}
+
+static uint32_t lb_sz(const LBTree *t, uint32_t k) { return k == LB_NIL ? 0 : t->node[k].size; }
+static int lb_ht(const LBTree *t, uint32_t k) { return k == LB_NIL ? 0 : (int)t->node[k].height; }
+
+static void lb_fix(LBTree *t, uint32_t k) {
+    LBNode *n = &t->node[k];
+    int hl = lb_ht(t, n->left), hr = lb_ht(t, n->right);
+    n->height = (uint32_t)((hl > hr ? hl : hr) + 1);
+    n->size = lb_sz(t, n->left) + lb_sz(t, n->right) + 1;
+}
+
+static uint32_t lb_rotate_right(LBTree *t, uint32_t k) {
+    uint32_t l = t->node[k].left;
+    t->node[k].left = t->node[l].right;
+    t->node[l].right = k;
+    lb_fix(t, k);
+    lb_fix(t, l);
+    return l;
+}
+
+static uint32_t lb_rotate_left(LBTree *t, uint32_t k) {
+    uint32_t r = t->node[k].right;
+    t->node[k].right = t->node[r].left;
+    t->node[r].left = k;
+    lb_fix(t, k);
+    lb_fix(t, r);
+    return r;
+}
+
+static uint32_t lb_balance(LBTree *t, uint32_t k) {
+    lb_fix(t, k);
+    LBNode *nd = t->node;
+    int bal = lb_ht(t, nd[k].left) - lb_ht(t, nd[k].right);
+    if (bal > 1) {
+        uint32_t l = nd[k].left;
+        if (lb_ht(t, nd[l].left) < lb_ht(t, nd[l].right)) nd[k].left = lb_rotate_left(t, l);
+        return lb_rotate_right(t, k);
+    }
+    if (bal < -1) {
+        uint32_t r = nd[k].right;
+        if (lb_ht(t, nd[r].right) < lb_ht(t, nd[r].left)) nd[k].right = lb_rotate_right(t, r);
+        return lb_rotate_left(t, k);
+    }
+    return k;
+}
+
+/* put node i (key e) into the subtree at k; equal keys go right, so ties
+   keep acceptance order */
+static uint32_t lb_tree_insert(LBTree *t, uint32_t k, uint32_t i, const LBEntry *e) {
+    if (k == LB_NIL) return i;
+    if (lb_node_cmp(&t->node[k], e) > 0) t->node[k].left = lb_tree_insert(t, t->node[k].left, i, e);
+    else t->node[k].right = lb_tree_insert(t, t->node[k].right, i, e);
+    return lb_balance(t, k);
+}
+
+/* balanced subtree over nodes lo..hi-1, which are in rank order already */
+static uint32_t lb_tree_build(LBTree *t, uint32_t lo, uint32_t hi) {
+    if (lo >= hi) return LB_NIL;
+    uint32_t mid = lo + (hi - lo) / 2;
+    t->node[mid].left = lb_tree_build(t, lo, mid);
+    t->node[mid].right = lb_tree_build(t, mid + 1, hi);
+    lb_fix(t, mid);
+    return mid;
+}
+
+/* entries strictly better than e */
+static size_t lb_count_better(const LBTree *t, const LBEntry *e) {
+    size_t r = 0;
+    for (uint32_t k = t->root; k != LB_NIL; ) {
+        if (lb_node_cmp(&t->node[k], e) < 0) { r += lb_sz(t, t->node[k].left) + 1; k = t->node[k].right; }
+        else k = t->node[k].left;
+    }
+    return r;
+}
+
+/* in-order walk from a given position: the stack holds the nodes still to
+   be visited whose left side is done */
+typedef struct {
+    const LBTree *t;
+    uint32_t stack[LB_MAX_DEPTH];
+    int sp;
+} LBIter;
+
+static void lb_iter_seek(LBIter *it, const LBTree *t, size_t k) {
+    it->t = t;
+    it->sp = 0;
+    uint32_t u = t->root;
+    while (u != LB_NIL) {
+        size_t ls = lb_sz(t, t->node[u].left);
+        if (k < ls) { it->stack[it->sp++] = u; u = t->node[u].left; }
+        else if (k == ls) { it->stack[it->sp++] = u; break; }
+        else { k -= ls + 1; u = t->node[u].right; }
+    }
+}
+
+/* the next entry's slot, LB_NIL at the end */
+static uint32_t lb_iter_next(LBIter *it) {
+    if (it->sp == 0) return LB_NIL;
+    const LBTree *t = it->t;
+    uint32_t k = it->stack[--it->sp];
+    for (uint32_t u = t->node[k].right; u != LB_NIL; u = t->node[u].left) it->stack[it->sp++] = u;
+    return t->slot ? t->slot[k] : k;
+}
+
+/* Add slot i (entry e) to a view's tree. With `append` the tree is only
+   built later (lb_views_build), for entries arriving in rank order. */
+static bool lb_tree_add(LBTree *t, uint32_t i, const LBEntry *e, bool append) {
+    if (t->n == t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : 16;
+        LBNode *nd = (LBNode*)realloc(t->node, cap * sizeof(LBNode));
+        if (!nd) return false;
+        t->node = nd;
+        uint32_t *sl = (uint32_t*)realloc(t->slot, cap * sizeof(uint32_t));
+        if (!sl) return false;
+        t->slot = sl;
+        t->cap = cap;
+    }
+    uint32_t k = (uint32_t)t->n++;
+    t->node[k] = (LBNode){ e->solved, e->time_sec, (int64_t)e->when, LB_NIL, LB_NIL, 1, 1 };
+    t->slot[k] = i;
+    if (!append) t->root = lb_tree_insert(t, t->root, k, e);
+    return true;
+}
+
+static void lb_tree_free(LBTree *t) {
+    free(t->node);
+    free(t->slot);
+    memset(t, 0, sizeof *t);
+    t->root = LB_NIL;
+}
+
+/* ---------------- Views ---------------- */
+
+/* Rankings of one puzzle, or of the day or week so far, are views: a
+   tree of their own over the same slots, filled as entries are added.
+   A day or week view holds one calendar window (local time), the one
+   the clock is in: entries dated outside it are left out, and once the
+   clock leaves it each view of it is emptied the next time it is
+   touched, keeping its storage. */
+typedef struct {
+    char     puzzle[LB_PUZZLE_LEN]; /* "" for every puzzle */
+    LBWindow window;
+    time_t   from;                  /* window the tree holds (day/week) */
+    LBTree   tree;
+} LBView;
+
+static LBView *lb_views = NULL;
+static size_t lb_nviews = 0, lb_views_cap = 0;
+static uint32_t *lb_view_index = NULL;  /* open addressing on (window, puzzle) */
+static size_t lb_view_index_cap = 0;
+static time_t lb_win_from[LB_WINDOWS], lb_win_to[LB_WINDOWS];  /* current [from, to) */
+
+/* local midnight starting the day of t, moved by `days` */
+static time_t lb_midnight(time_t t, int days) {
+    struct tm tm;
+    struct tm *p = localtime(&t);
+    if (!p) return t;
+    tm = *p;
+    tm.tm_mday += days;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+/* move the day and week windows to the ones holding now (the current
+   time, never an entry's: a future-dated row must not drag them along) */
+static void lb_windows_update(time_t now) {
+    if (now >= lb_win_from[LB_TODAY] && now < lb_win_to[LB_TODAY]) return;
+    lb_win_from[LB_TODAY] = lb_midnight(now, 0);
+    lb_win_to[LB_TODAY] = lb_midnight(now, 1);
+    if (now >= lb_win_from[LB_THIS_WEEK] && now < lb_win_to[LB_THIS_WEEK]) return;
+    struct tm *p = localtime(&now);
+    int since_monday = p ? (p->tm_wday + 6) % 7 : 0;
+    lb_win_from[LB_THIS_WEEK] = lb_midnight(now, -since_monday);
+    lb_win_to[LB_THIS_WEEK] = lb_midnight(now, 7 - since_monday);
+}
+
+static uint32_t lb_view_hash(LBWindow w, const char *puzzle) {
+    return lb_hash(puzzle, strlen(puzzle)) ^ ((uint32_t)w * 0x9E3779B9u);
+}
+
+static size_t lb_view_slot(LBWindow w, const char *puzzle) {
+    size_t mask = lb_view_index_cap - 1;
+    size_t h = lb_view_hash(w, puzzle) & mask;
+    for (uint32_t v; (v = lb_view_index[h]) != LB_NIL; h = (h + 1) & mask)
+        if (lb_views[v].window == w && strcmp(lb_views[v].puzzle, puzzle) == 0) break;
+    return h;
+}
+
+static bool lb_view_index_grow(void) {
+    size_t cap = lb_view_index_cap ? lb_view_index_cap * 2 : 64;
+    uint32_t *idx = (uint32_t*)malloc(cap * sizeof(uint32_t));
+    if (!idx) return false;
+    for (size_t k = 0; k < cap; ++k) idx[k] = LB_NIL;
+    free(lb_view_index);
+    lb_view_index = idx;
+    lb_view_index_cap = cap;
+    for (uint32_t v = 0; v < lb_nviews; ++v)
+        lb_view_index[lb_view_slot(lb_views[v].window, lb_views[v].puzzle)] = v;
+    return true;
+}
+
+/* the view for (w, puzzle), created if `create`; NULL if none. A day or
+   week view still holding an earlier window is emptied first. */
+static LBView *lb_view_get(LBWindow w, const char *puzzle, bool create) {
+    LBView *v = NULL;
+    size_t h = 0;
+    if (lb_view_index_cap) {
+        h = lb_view_slot(w, puzzle);
+        if (lb_view_index[h] != LB_NIL) v = &lb_views[lb_view_index[h]];
+    }
+    if (!v) {
+        if (!create) return NULL;
+        if ((lb_nviews + 1) * 2 > lb_view_index_cap) {
+            if (!lb_view_index_grow()) return NULL;
+        }
+        if (lb_nviews == lb_views_cap) {
+            size_t cap = lb_views_cap ? lb_views_cap * 2 : 16;
+            LBView *p = (LBView*)realloc(lb_views, cap * sizeof(LBView));
+            if (!p) return NULL;
+            lb_views = p;
+            lb_views_cap = cap;
+        }
+        h = lb_view_slot(w, puzzle);
+        v = &lb_views[lb_nviews];
+        memset(v, 0, sizeof *v);
+        strncpy(v->puzzle, puzzle, LB_PUZZLE_LEN - 1);
+        v->window = w;
+        v->from = lb_win_from[w];
+        v->tree.root = LB_NIL;
+        lb_view_index[h] = (uint32_t)lb_nviews++;
+    }
+    if (w != LB_ALL_TIME && v->from != lb_win_from[w]) {
+        v->tree.n = 0;
+        v->tree.root = LB_NIL;
+        v->from = lb_win_from[w];
+    }
+    return v;
+}
+
+/* add slot i to every view it belongs in besides the main tree */
+static void lb_views_note(uint32_t i, bool append) {
+    const LBEntry *e = LB_AT(i);
+    for (int w = 0; w < LB_WINDOWS; ++w) {
+        if (w != LB_ALL_TIME && (e->when < lb_win_from[w] || e->when >= lb_win_to[w])) continue;
+        LBView *v;
+        if (w != LB_ALL_TIME && (v = lb_view_get((LBWindow)w, "", true)) != NULL)
+            lb_tree_add(&v->tree, i, e, append);
+        if (e->puzzle[0] && (v = lb_view_get((LBWindow)w, e->puzzle, true)) != NULL)
+            lb_tree_add(&v->tree, i, e, append);
+    }
+}
+
+/* trees of views filled in append mode */
+static void lb_views_build(void) {
+    for (size_t v = 0; v < lb_nviews; ++v)
+        lb_views[v].tree.root = lb_tree_build(&lb_views[v].tree, 0, (uint32_t)lb_views[v].tree.n);
+}
+
+static void lb_views_free(void) {
+    for (size_t v = 0; v < lb_nviews; ++v) lb_tree_free(&lb_views[v].tree);
+    free(lb_views);
+    free(lb_view_index);
+    lb_views = NULL;
+    lb_view_index = NULL;
+    lb_nviews = lb_views_cap = lb_view_index_cap = 0;
+}
+
+/* a field of a CSV or journal line: no separators, no line breaks */
+static void lb_copy_field(char *dst, const char *src, size_t size) {
+    size_t k = 0;
+    for (; src && src[k] && k < size - 1; ++k)
+        dst[k] = (src[k] == ',' || src[k] == '\n' || src[k] == '\r') ? ' ' : src[k];
+    memset(dst + k, 0, size - k);
+}
+
+/* the tree for a view (puzzle as lb_add stores it); the main one for
+   all puzzles of all time, an empty one for a view with no entries yet */
+static const LBTree *lb_view_tree(LBWindow w, const char *puzzle) {
+    static const LBTree empty = { NULL, NULL, 0, 0, LB_NIL };
+    char key[LB_PUZZLE_LEN];
+    lb_copy_field(key, puzzle, sizeof key);
+    lb_windows_update(time(NULL));
+    if (w == LB_ALL_TIME && !key[0]) return &lb_all;
+    const LBView *v = lb_view_get(w, key, false);
+    return v ? &v->tree : &empty;
+}
+
+/* ---------------- Name index ---------------- */
+
+static size_t lb_name_find(const char *name) {
+    size_t mask = lb_names_cap - 1;
+    size_t h = lb_hash(name, strlen(name)) & mask;
+    while (lb_names[h].best != LB_NIL && strcmp(LB_AT(lb_names[h].best)->name, name) != 0) h = (h + 1) & mask;
+    return h;
+}
+
+static bool lb_names_grow(void) {
+    size_t cap = lb_names_cap ? lb_names_cap * 2 : 64;
+    LBPlayer *old = lb_names;
+    size_t old_cap = lb_names_cap;
+    lb_names = (LBPlayer*)malloc(cap * sizeof(LBPlayer));
+    if (!lb_names) { lb_names = old; return false; }
+    for (size_t k = 0; k < cap; ++k) lb_names[k].best = LB_NIL;
+    lb_names_cap = cap;
+    for (size_t k = 0; k < old_cap; ++k)
+        if (old[k].best != LB_NIL) lb_names[lb_name_find(LB_AT(old[k].best)->name)] = old[k];
+    free(old);
+    return true;
+}
+
+/* count slot i in its player's totals, and keep it as their best if it
+   beats the one on record */
+static void lb_name_note(uint32_t i) {
+    if ((lb_names_used + 1) * 2 > lb_names_cap && !lb_names_grow()) return;
+    const LBEntry *e = LB_AT(i);
+    LBPlayer *p = &lb_names[lb_name_find(e->name)];
+    if (p->best == LB_NIL) {
+        *p = (LBPlayer){ i, 0, 0, 0 };
+        ++lb_names_used;
+    } else if (lb_cmp(e, LB_AT(p->best)) < 0) {
+        p->best = i;
+    }
+    ++p->plays;
+    p->sum_solved += e->solved;
+    p->sum_time += e->time_sec;
+}
+
+/* ---------------- Table ---------------- */
+
+#define LB_GROW(arr, type, cap) do {                                         \
+        type *p_ = (type*)realloc((arr), (cap) * sizeof(type));              \
+        if (!p_) return false;                                               \
+        (arr) = p_;                                                          \
+    } while (0)
+
+/* room for slot lb_used: tree nodes and a chunk for it (the chunk last,
+   so a failure never leaves one allocated but unaccounted for) */
+static bool lb_reserve(void) {
+    if (lb_used >= LB_NIL) return false;
+    if (lb_used == lb_all.cap) {
+        size_t cap = lb_all.cap ? lb_all.cap * 2 : 256;
+        LB_GROW(lb_all.node, LBNode, cap);
+        lb_all.cap = cap;
+    }
+    size_t chunk = lb_used / LB_CHUNK;
+    if (chunk == lb_chunk_cap) {
+        size_t cap = lb_chunk_cap ? lb_chunk_cap * 2 : 16;
+        LB_GROW(lb_chunks, LBEntry*, cap);
+        lb_chunk_cap = cap;
+    }
+    if (lb_used % LB_CHUNK == 0) {
+        lb_chunks[chunk] = (LBEntry*)malloc(LB_CHUNK * sizeof(LBEntry));
+        if (!lb_chunks[chunk]) return false;
+    }
+    return true;
+}
+
+/* add e to the table and every view of it; false only when out of memory */
+static bool lb_insert(const LBEntry *e) {
+    if (!lb_reserve()) return false;
+    uint32_t i = (uint32_t)lb_used;
+    *LB_AT(i) = *e;
+    lb_all.node[i] = (LBNode){ e->solved, e->time_sec, (int64_t)e->when, LB_NIL, LB_NIL, 1, 1 };
+    lb_all.n = ++lb_used;
+    lb_all.root = lb_tree_insert(&lb_all, lb_all.root, i, e);
+    lb_name_note(i);
+    lb_windows_update(time(NULL));
+    lb_views_note(i, false);
+    return true;
+}
+
+static void lb_map_close(LBMap *m);
+
+static void lb_free_table(void) {
+    for (size_t c = lb_map_chunks; c * LB_CHUNK < lb_used; ++c) free(lb_chunks[c]);
+    lb_map_close(&lb_map);
+    lb_map_chunks = 0;
+    free(lb_chunks);
+    free(lb_all.node);
+    free(lb_names);
+    lb_views_free();
+    lb_chunks = NULL;
+    lb_all.node = NULL;
+    lb_names = NULL;
+    lb_chunk_cap = lb_all.cap = lb_all.n = lb_names_cap = lb_names_used = lb_used = lb_sorted_len = 0;
+    lb_all.root = LB_NIL;
+}
+
+/* ---------------- Loading ---------------- */
+
+/* one "name,solved,time_sec,when[,puzzle]" line (newline already trimmed) */
+static bool lb_parse_entry(char *p, LBEntry *e) {
+    /* we'll parse by tokens using strtok to avoid scanf format issues */
+    char *name_tok = strtok(p, ",");
+    if (!name_tok) return false;
+    char *solved_tok = strtok(NULL, ",");
+    char *time_tok = strtok(NULL, ",");
+    char *when_tok = strtok(NULL, ",");
+    if (!solved_tok || !time_tok || !when_tok) return false;
+    char *puzzle_tok = strtok(NULL, "\r");   /* older files have none */
+
+    /* parse numbers safely */
+    char *endptr = NULL;
+    long solved = strtol(solved_tok, &endptr, 10);
+    if (endptr == solved_tok) return false;
+    long time_sec = strtol(time_tok, &endptr, 10);
+    if (endptr == time_tok) return false;
+    long long when_ll = strtoll(when_tok, &endptr, 10);
+    if (endptr == when_tok) return false;
+
+    strncpy(e->name, name_tok, LB_NAME_LEN - 1);
+    e->name[LB_NAME_LEN - 1] = '\0';
+    e->solved = (int)solved;
+    e->time_sec = (int)time_sec;
+    e->when = (time_t)when_ll;
+    memset(e->puzzle, 0, LB_PUZZLE_LEN);
+    if (puzzle_tok) strncpy(e->puzzle, puzzle_tok, LB_PUZZLE_LEN - 1);
+    return true;
+}
+
+static bool lb_same_entry(const LBEntry *a, const LBEntry *b) {
+    return a->solved == b->solved && a->time_sec == b->time_sec && a->when == b->when &&
+           strcmp(a->name, b->name) == 0 && strcmp(a->puzzle, b->puzzle) == 0;
+}
+
+/* whether e, read from the files, is one of our own entries coming back
+   (it is then no longer unseen) */
+static bool lb_take_own(const LBEntry *e) {
+    for (size_t i = 0; i < lb_unseen_len; ++i) {
+        if (lb_same_entry(&lb_unseen[i], e)) {
+            lb_unseen[i] = lb_unseen[--lb_unseen_len];
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Read CSV snapshot lines from byte offset `from` into the table: the
+   whole file into an empty one, or (`more`) the lines added since an
+   earlier read, skipping our own. Returns the offset just past the last
+   complete line, or -1 if there is no file. */
+static long lb_read_snapshot(const char *path, long from, bool more) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    if (from && fseek(f, from, SEEK_SET) != 0) { fclose(f); return from; }
+    long end = from;
     char line[512];
-    while (fgets(line, sizeof line, f) && lb_used < LB_MAX_ENTRIES) {
-        /* CSV format: name,solved,time_sec,when */
-        /* we'll parse by tokens using strtok to avoid scanf format issues */
+    while (fgets(line, sizeof line, f)) {
+        /* CSV format: name,solved,time_sec,when[,puzzle] */
         char *p = line;
         /* trim newline */
         size_t L = strlen(p);
-        if (L && p[L-1] == '\n') p[L-1] = '\0';
+        if (L && p[L-1] == '\n') { p[L-1] = '\0'; end = ftell(f); }
+        if (strncmp(p, "#folded ", 8) == 0) { lb_snapshot_folded = strtoull(p + 8, NULL, 10); continue; }
+        LBEntry e;
+        if (!lb_parse_entry(p, &e)) continue;
+        if (more && lb_take_own(&e)) continue;
+        if (!lb_insert(&e)) break;
+    }
+    fclose(f);
+    return end;
+}
 
-        char *name_tok = strtok(p, ",");
-        if (!name_tok) continue;
-        char *solved_tok = strtok(NULL, ",");
-        char *time_tok = strtok(NULL, ",");
-        char *when_tok = strtok(NULL, ",");
-        if (!solved_tok || !time_tok || !when_tok) continue;
+/* ---------------- Binary snapshot ---------------- */
 
-        /* parse numbers safely */
-        char *endptr = NULL;
-        long solved = strtol(solved_tok, &endptr, 10);
-        if (endptr == solved_tok) continue;
-        long time_sec = strtol(time_tok, &endptr, 10);
-        if (endptr == time_tok) continue;
-        long long when_ll = strtoll(when_tok, &endptr, 10);
-        if (endptr == when_tok) continue;
+/* LB_BIN_FILE, native byte order (like the puzzle pack):
+     LBBinHeader    magic, version, record size, count, folded journal gen
+     count LBRecord, best first (lb_cmp order)
+   Loading maps the file. Where LBRecord and LBEntry have the same layout,
+   the full chunks of it are used in place; the tree is built bottom-up
+   from the order the file already has, and nothing is parsed. */
+#define LB_BIN_MAGIC   0x424C5743u   /* "CWLB" little-endian */
+#define LB_BIN_VERSION 2u      /* 2: records carry the puzzle */
+
+typedef struct {
+    uint32_t magic, version, record_size, reserved;
+    uint64_t count;
+    uint64_t folded;            /* journal generation taken in, or LB_ANY_GEN */
+} LBBinHeader;
 
+typedef struct {
+    char    name[LB_NAME_LEN];
+    int32_t solved, time_sec;
+    int64_t when;
+    char    puzzle[LB_PUZZLE_LEN];
+} LBRecord;
+
+typedef struct {                /* version 1, still read */
+    char    name[LB_NAME_LEN];
+    int32_t solved, time_sec;
+    int64_t when;
+} LBRecordV1;
+
+#define LB_RECORD_IS_ENTRY                                                   \
+    (sizeof(LBRecord) == sizeof(LBEntry) && sizeof(time_t) == sizeof(int64_t) && \
+     offsetof(LBRecord, solved) == offsetof(LBEntry, solved) &&             \
+     offsetof(LBRecord, time_sec) == offsetof(LBEntry, time_sec) &&         \
+     offsetof(LBRecord, when) == offsetof(LBEntry, when) &&                 \
+     offsetof(LBRecord, puzzle) == offsetof(LBEntry, puzzle))
+
+static void lb_map_close(LBMap *m) {
+    if (!m->base) return;
+#ifndef _WIN32
+    if (m->mapped) munmap(m->base, m->len);
+    else
+#endif
+    free(m->base);
+    memset(m, 0, sizeof *m);
+}
+
+/* map the file at path (or read it whole where there is no mmap); an
+   empty file counts as missing */
+static bool lb_map_open(const char *path, LBMap *m) {
+    memset(m, 0, sizeof *m);
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    m->base = map;
+    m->len = (size_t)st.st_size;
+    m->mapped = true;
+    return true;
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    if (fseek(f, 0, SEEK_END) != 0) { fclose(f); return false; }
+    long sz = ftell(f);
+    rewind(f);
+    if (sz <= 0) { fclose(f); return false; }
+    void *buf = malloc((size_t)sz);
+    bool ok = buf && fread(buf, 1, (size_t)sz, f) == (size_t)sz;
+    fclose(f);
+    if (!ok) { free(buf); return false; }
+    m->base = buf;
+    m->len = (size_t)sz;
+    return true;
+#endif
+}
+
+/* records of a mapped snapshot after checking its header (LBRecord, or
+   LBRecordV1 if h->version is 1); NULL if it is not one */
+static const void *lb_bin_records(const void *base, size_t len, LBBinHeader *h) {
+    if (len < sizeof *h) return NULL;
+    memcpy(h, base, sizeof *h);
+    size_t size = h->version == 1 ? sizeof(LBRecordV1) : sizeof(LBRecord);
+    if (h->magic != LB_BIN_MAGIC || (h->version != 1 && h->version != LB_BIN_VERSION) ||
+        h->record_size != size)
+        return NULL;
+    if (h->count >= LB_NIL || (len - sizeof *h) / size != h->count) return NULL;
+    return (const char*)base + sizeof *h;
+}
+
+/* record i of a snapshot's records, of the given version */
+static void lb_from_record(const void *records, uint32_t version, size_t i, LBEntry *e) {
+    if (version == 1) {
+        const LBRecordV1 *r = (const LBRecordV1*)records + i;
+        memcpy(e->name, r->name, LB_NAME_LEN);
+        e->solved = r->solved;
+        e->time_sec = r->time_sec;
+        e->when = (time_t)r->when;
+        memset(e->puzzle, 0, LB_PUZZLE_LEN);
+    } else {
+        const LBRecord *r = (const LBRecord*)records + i;
+        memcpy(e->name, r->name, LB_NAME_LEN);
+        e->solved = r->solved;
+        e->time_sec = r->time_sec;
+        e->when = (time_t)r->when;
+        memcpy(e->puzzle, r->puzzle, LB_PUZZLE_LEN);
+        e->puzzle[LB_PUZZLE_LEN - 1] = '\0';
+    }
+    e->name[LB_NAME_LEN - 1] = '\0';
+}
+
+/* Load the binary snapshot at path into the empty table; false if there
+   is none (or it is damaged). Records out of order are inserted one by
+   one rather than trusted. */
+static bool lb_load_bin(const char *path) {
+    if (!lb_map_open(path, &lb_map)) return false;
+    LBBinHeader h;
+    const LBRecord *rec = (const LBRecord*)lb_bin_records(lb_map.base, lb_map.len, &h);
+    if (!rec) { lb_map_close(&lb_map); return false; }
+    size_t n = (size_t)h.count;
+
+    /* chunks can point into the mapping only if every name is terminated
+       (and the records are current ones) */
+    bool in_place = LB_RECORD_IS_ENTRY && h.version == LB_BIN_VERSION;
+    for (size_t i = 0; in_place && i < n; ++i)
+        if (!memchr(rec[i].name, '\0', LB_NAME_LEN) || !memchr(rec[i].puzzle, '\0', LB_PUZZLE_LEN))
+            in_place = false;
+    size_t nchunks = n / LB_CHUNK + 1;
+    lb_all.node = (LBNode*)malloc((n ? n : 1) * sizeof(LBNode));
+    lb_chunks = (LBEntry**)malloc(nchunks * sizeof(LBEntry*));
+    if (!lb_all.node || !lb_chunks) { lb_free_table(); return false; }
+    lb_all.cap = n ? n : 1;
+    lb_chunk_cap = nchunks;
+    if (in_place) {
+        lb_map_chunks = n / LB_CHUNK;
+        for (size_t c = 0; c < lb_map_chunks; ++c) lb_chunks[c] = (LBEntry*)(rec + c * LB_CHUNK);
+        lb_used = lb_map_chunks * LB_CHUNK;
+    }
+    for (; lb_used < n; ++lb_used) {
+        if (!lb_reserve()) { lb_free_table(); return false; }
+        lb_from_record(rec, h.version, lb_used, LB_AT(lb_used));
+    }
+
+    bool sorted = true;
+    for (uint32_t i = 0; i < (uint32_t)n; ++i) {
+        const LBEntry *e = LB_AT(i);
+        lb_all.node[i] = (LBNode){ e->solved, e->time_sec, (int64_t)e->when, LB_NIL, LB_NIL, 1, 1 };
+        if (i && lb_cmp(LB_AT(i - 1), e) > 0) sorted = false;
+    }
+    lb_all.n = n;
+    /* the day and week views hold entries from now on back, not from
+       whenever the oldest record was made */
+    lb_windows_update(time(NULL));
+    for (uint32_t i = 0; i < (uint32_t)n; ++i) {
+        lb_name_note(i);
+        lb_views_note(i, sorted);
+    }
+    if (sorted) {
+        lb_all.root = lb_tree_build(&lb_all, 0, (uint32_t)n);
+        lb_views_build();
+        lb_sorted_len = n;
+    } else {
+        for (uint32_t i = 0; i < (uint32_t)n; ++i) lb_all.root = lb_tree_insert(&lb_all, lb_all.root, i, LB_AT(i));
+    }
+    lb_snapshot_folded = h.folded;
+    if (!lb_map_chunks) lb_map_close(&lb_map);     /* everything was copied */
+    return true;
+}
+
+static long lb_load(void) {
+    lb_free_table();
+    lb_snapshot_folded = LB_ANY_GEN;
+    lb_windows_update(time(NULL));
+    if (lb_opt.binary && lb_load_bin(LB_BIN_FILE)) return 0;
+    long end = lb_read_snapshot(LB_FILE, 0, false);
+    return end < 0 ? 0 : end;
+}
+
+/* ---------------- Journal ---------------- */
+
+/* The journal opens with a "#gen N" line. N goes up each time the
+   journal is emptied into a new snapshot, so a reader holding an offset
+   into it can tell whether the offset still means anything. Then one
+   record per line, "name,solved,time_sec,when[,puzzle],checksum", in the order
+   they were accepted. In shared mode a journal being emptied is first
+   moved to LB_JOURNAL_PREV, where readers part-way through it finish.
+   A snapshot that took in a journal ends with "#folded <its gen>". */
+#define LB_JOURNAL_PREV LB_JOURNAL_FILE ".prev"
+
+typedef struct {
+    uint64_t gen;
+    long     end;       /* offset just past the last complete line */
+    size_t   records;   /* complete record lines */
+} LBJournalScan;
+
+/* add a record read from the files, unless it is our own coming back */
+static void lb_apply(const LBEntry *e, void *arg) {
+    (void)arg;
+    if (!lb_take_own(e)) lb_insert(e);
+}
+
+/* lb_apply, for a journal the loaded snapshot has not folded in already
+   (a crash came between the two); arg is the scan's LBJournalScan */
+static void lb_apply_unfolded(const LBEntry *e, void *arg) {
+    if (((const LBJournalScan*)arg)->gen != lb_snapshot_folded) lb_apply(e, NULL);
+}
+
+/* Call fn on each record of the journal at path from byte offset `from`
+   (0: the start). A record with a bad checksum was cut short by a crash
+   and is skipped; a last line without its newline is left for the next
+   scan. False if the file is missing or its generation is not `gen`
+   (unless LB_ANY_GEN). */
+static bool lb_scan_journal(const char *path, uint64_t gen, long from,
+                            void (*fn)(const LBEntry *e, void *arg), void *arg,
+                            LBJournalScan *out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    memset(out, 0, sizeof *out);
+    char line[512];
+    if (fgets(line, sizeof line, f) && strncmp(line, "#gen ", 5) == 0 && strchr(line, '\n'))
+        out->gen = strtoull(line + 5, NULL, 10);
+    else
+        rewind(f);      /* no header yet: generation 0 */
+    if (gen != LB_ANY_GEN && out->gen != gen) { fclose(f); return false; }
+    if (from > ftell(f) && fseek(f, from, SEEK_SET) != 0) { fclose(f); return false; }
+    out->end = ftell(f);
+    while (fgets(line, sizeof line, f)) {
+        size_t L = strlen(line);
+        if (L == 0 || line[L-1] != '\n') {
+            if (feof(f)) break;
+            /* an overlong line is junk: skip the rest of it */
+            int c;
+            while ((c = fgetc(f)) != EOF && c != '\n') {}
+            if (c == EOF) break;
+            out->end = ftell(f);
+            continue;
+        }
+        out->end = ftell(f);
+        line[--L] = '\0';
+        ++out->records;
+        char *sum = strrchr(line, ',');
+        if (!sum) continue;
+        char *endptr = NULL;
+        unsigned long want = strtoul(sum + 1, &endptr, 16);
+        if (endptr == sum + 1 || *endptr || want != lb_hash(line, (size_t)(sum - line))) continue;
+        *sum = '\0';
         LBEntry e;
-        strncpy(e.name, name_tok, LB_NAME_LEN - 1);
-        e.name[LB_NAME_LEN - 1] = '\0';
-        e.solved = (int)solved;
-        e.time_sec = (int)time_sec;
-        e.when = (time_t)when_ll;
-        lb_store[lb_used++] = e;
+        if (lb_parse_entry(line, &e)) fn(&e, arg);
     }
     fclose(f);
-    if (lb_used) qsort(lb_store, lb_used, sizeof(LBEntry), lb_cmp);
+    return true;
+}
+
+/* ---------------- Persistence ---------------- */
+
+#define LB_TMP_FILE  LB_FILE ".tmp"
+#define LB_LOCK_FILE LB_FILE ".lock"
+
+static bool lb_sync_file(FILE *f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+/* flush, optionally fsync, and close; false if any step failed */
+static bool lb_close_file(FILE *f, bool sync) {
+    bool ok = fflush(f) == 0 && !ferror(f);
+    if (ok && sync) ok = lb_sync_file(f);
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+static void lb_write_entry(FILE *f, const LBEntry *e) {
+    fprintf(f, "%s,%d,%d,%lld%s%s\n", e->name, e->solved, e->time_sec, (long long)e->when,
+            e->puzzle[0] ? "," : "", e->puzzle);
+}
+
+static void lb_emit(const LBEntry *e, void *arg) {
+    lb_write_entry((FILE*)arg, e);
+}
+
+/* rewrite the whole file at path from the first n slots of a chunk
+   directory, in acceptance order, marked as holding journal generation
+   `folded` unless LB_ANY_GEN; fsync it when `sync` */
+static bool lb_write_file(const char *path, LBEntry *const *chunks, size_t n, uint64_t folded, bool sync) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    for (size_t i = 0; i < n; ++i) lb_write_entry(f, &chunks[i / LB_CHUNK][i % LB_CHUNK]);
+    if (folded != LB_ANY_GEN) fprintf(f, "#folded %llu\n", (unsigned long long)folded);
+    return lb_close_file(f, sync);
+}
+
+static void lb_to_record(const LBEntry *e, LBRecord *r) {
+    size_t len = strlen(e->name);
+    memset(r->name, 0, LB_NAME_LEN);
+    memcpy(r->name, e->name, len < LB_NAME_LEN ? len : LB_NAME_LEN - 1);
+    r->solved = e->solved;
+    r->time_sec = e->time_sec;
+    r->when = (int64_t)e->when;
+    len = strlen(e->puzzle);
+    memset(r->puzzle, 0, LB_PUZZLE_LEN);
+    memcpy(r->puzzle, e->puzzle, len < LB_PUZZLE_LEN ? len : LB_PUZZLE_LEN - 1);
 }
 
-static void lb_save(void) {
-    FILE *f = fopen(LB_FILE, "w");
-    if (!f) return;
-    for (size_t i = 0; i < lb_used; ++i) {
-        fprintf(f, "%s,%d,%d,%lld\n",
-                lb_store[i].name,
-                lb_store[i].solved,
-                lb_store[i].time_sec,
-                (long long)lb_store[i].when);
+/* a run of entries in rank order: slots of a chunk directory, or the
+   records of a binary snapshot */
+typedef struct {
+    LBEntry *const *chunks;
+    const void *records;
+    size_t n;
+    uint32_t version;           /* of the records */
+} LBRun;
+
+static void lb_run_get(const LBRun *run, size_t i, LBEntry *out) {
+    if (run->chunks) *out = run->chunks[i / LB_CHUNK][i % LB_CHUNK];
+    else lb_from_record(run->records, run->version, i, out);
+}
+
+/* Write a binary snapshot to path and sync it: the run merged with
+   extra[0..n), which is sorted here. */
+static bool lb_write_bin(const char *path, const LBRun *run, LBEntry *extra, size_t n, uint64_t folded) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    qsort(extra, n, sizeof(LBEntry), lb_cmp);
+    LBBinHeader h = { LB_BIN_MAGIC, LB_BIN_VERSION, (uint32_t)sizeof(LBRecord), 0,
+                      (uint64_t)(run->n + n), folded };
+    fwrite(&h, sizeof h, 1, f);
+    size_t i = 0, j = 0;
+    LBEntry a;
+    if (run->n) lb_run_get(run, 0, &a);
+    while (i < run->n || j < n) {
+        LBRecord r;
+        if (j == n || (i < run->n && lb_cmp(&a, &extra[j]) <= 0)) {
+            lb_to_record(&a, &r);
+            if (++i < run->n) lb_run_get(run, i, &a);
+        } else {
+            lb_to_record(&extra[j++], &r);
+        }
+        fwrite(&r, sizeof r, 1, f);
     }
-    fclose(f);
+    return lb_close_file(f, true);
 }
 
-void lb_shutdown(void) {
-    lb_save();
+/* binary snapshot of the first n slots of a chunk directory; slots below
+   `sorted` are in rank order already, only the rest need sorting */
+static bool lb_write_bin_table(const char *path, LBEntry *const *chunks, size_t n, size_t sorted,
+                               uint64_t folded) {
+    size_t nt = n - sorted;
+    LBEntry *tail = (LBEntry*)malloc((nt ? nt : 1) * sizeof(LBEntry));
+    if (!tail) return false;
+    for (size_t i = sorted; i < n; ++i) tail[i - sorted] = chunks[i / LB_CHUNK][i % LB_CHUNK];
+    LBRun run = { chunks, NULL, sorted, LB_BIN_VERSION };
+    bool ok = lb_write_bin(path, &run, tail, nt, folded);
+    free(tail);
+    return ok;
 }
 
-bool lb_add(const char *name, int solved, int time_sec) {
-    if (!name || name[0] == '\0') return false;
-    LBEntry newe;
-    strncpy(newe.name, name, LB_NAME_LEN - 1); newe.name[LB_NAME_LEN - 1] = '\0';
-    newe.solved = solved; newe.time_sec = time_sec; newe.when = time(NULL);
+/* rename from over to, so a crash leaves one or the other complete, and
+   make the rename itself durable */
+static bool lb_replace_file(const char *from, const char *to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(from, to) != 0) return false;
+    int dir = open(".", O_RDONLY);
+    if (dir >= 0) { fsync(dir); close(dir); }
+    return true;
+#endif
+}
+
+/* Open the journal for appending. A new file gets its "#gen" line; a
+   record torn by a crash is ended first, so the next one starts on a
+   line of its own (and the torn one fails its checksum). */
+static FILE *lb_open_journal(uint64_t gen) {
+    FILE *f = fopen(LB_JOURNAL_FILE, "a+b");
+    if (!f) return NULL;
+    if (fseek(f, 0, SEEK_END) == 0 && ftell(f) == 0) {
+        fprintf(f, "#gen %llu\n", (unsigned long long)gen);
+    } else if (fseek(f, -1, SEEK_END) == 0 && fgetc(f) != '\n') {
+        fseek(f, 0, SEEK_END);
+        fputc('\n', f);
+    }
+    fseek(f, 0, SEEK_END);
+    return f;
+}
+
+static bool lb_write_journal(FILE *f, const LBEntry *entries, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        char rec[160];
+        int len = snprintf(rec, sizeof rec, "%s,%d,%d,%lld%s%s",
+                           entries[i].name, entries[i].solved, entries[i].time_sec,
+                           (long long)entries[i].when, entries[i].puzzle[0] ? "," : "",
+                           entries[i].puzzle);
+        fprintf(f, "%s,%08lx\n", rec, (unsigned long)lb_hash(rec, (size_t)len));
+    }
+    return fflush(f) == 0;
+}
+
+/* append records to the journal in one write */
+static bool lb_append_journal(const LBEntry *entries, size_t n, bool sync, uint64_t gen) {
+    if (!lb_journal) lb_journal = lb_open_journal(gen);
+    if (!lb_journal) return false;
+    bool ok = lb_write_journal(lb_journal, entries, n);
+    if (ok && sync) ok = lb_sync_file(lb_journal);
+    return ok;
+}
+
+/* start the journal over at generation gen */
+static FILE *lb_reset_journal(uint64_t gen) {
+    FILE *f = fopen(LB_JOURNAL_FILE, "wb");
+    if (!f) return NULL;
+    fprintf(f, "#gen %llu\n", (unsigned long long)gen);
+    fflush(f);
+    return f;
+}
+
+/* New snapshot from entries[0..n): written and synced under a temporary
+   name, then renamed over the old one, so a crash leaves either snapshot
+   complete. Only then is the journal emptied. */
+static bool lb_compact(LBEntry *const *chunks, size_t n, size_t sorted, uint64_t gen) {
+    bool ok = lb_opt.binary ? lb_write_bin_table(LB_TMP_FILE, chunks, n, sorted, gen)
+                            : lb_write_file(LB_TMP_FILE, chunks, n, gen, true);
+    if (!ok || !lb_replace_file(LB_TMP_FILE, lb_opt.binary ? LB_BIN_FILE : LB_FILE)) {
+        remove(LB_TMP_FILE);
+        return false;
+    }
+    if (lb_journal) fclose(lb_journal);
+    lb_journal = lb_reset_journal(gen + 1);
+    return true;
+}
+
+/* ---------------- Shared storage ---------------- */
+
+/* With LBPersistOptions.shared, several processes use the same files.
+   Writers take an exclusive advisory lock on LB_LOCK_FILE and only ever
+   merge what is on disk with their own new entries (nobody writes from
+   an in-memory table); readers take it shared. Each process notices
+   changes by stat()ing the file it follows and reads only what was
+   added: the snapshot in CSV mode, which merges keep as a prefix of the
+   new file, or the journal from where it left off. */
+
+#define LB_LOCK_BUSY (-2)
+
+/* Take the lock, exclusive to write the files or shared to read them.
+   The lock file is opened on every call, so threads of one process
+   exclude each other too. Returns a handle for lb_file_unlock, -1 on
+   error, or LB_LOCK_BUSY if !wait and another holder is in the way. */
+static int lb_file_lock(bool exclusive, bool wait) {
+#ifdef _WIN32
+    int fd = _open(LB_LOCK_FILE, _O_RDWR | _O_CREAT, _S_IREAD | _S_IWRITE);
+    if (fd < 0) return -1;
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof ov);
+    DWORD flags = (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0) | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+    if (!LockFileEx((HANDLE)_get_osfhandle(fd), flags, 0, 1, 0, &ov)) {
+        bool busy = GetLastError() == ERROR_LOCK_VIOLATION;
+        _close(fd);
+        return busy ? LB_LOCK_BUSY : -1;
+    }
+#else
+    int fd = open(LB_LOCK_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    while (flock(fd, (exclusive ? LOCK_EX : LOCK_SH) | (wait ? 0 : LOCK_NB)) != 0) {
+        if (errno == EWOULDBLOCK) { close(fd); return LB_LOCK_BUSY; }
+        if (errno != EINTR) { close(fd); return -1; }
+    }
+#endif
+    return fd;
+}
+
+static void lb_file_unlock(int fd) {
+    if (fd < 0) return;
+#ifdef _WIN32
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof ov);
+    UnlockFileEx((HANDLE)_get_osfhandle(fd), 0, 1, 0, &ov);
+    _close(fd);
+#else
+    close(fd);      /* releases the flock */
+#endif
+}
+
+/* what a stat() says about a file; any change means it was written */
+typedef struct {
+    bool exists;
+    unsigned long long ino;
+    long long size, mtime;
+} LBFileSig;
+
+static void lb_file_sig(const char *path, LBFileSig *s) {
+    struct stat st;
+    memset(s, 0, sizeof *s);
+    if (stat(path, &st) != 0) return;
+    s->exists = true;
+    s->ino = (unsigned long long)st.st_ino;
+    s->size = (long long)st.st_size;
+    s->mtime = (long long)st.st_mtime;
+}
+
+static bool lb_sig_equal(const LBFileSig *a, const LBFileSig *b) {
+    return a->exists == b->exists && a->ino == b->ino && a->size == b->size && a->mtime == b->mtime;
+}
+
+/* Copy the snapshot as it is on disk to out, leaving out "#folded N"
+   markers; *folded gets the generation in the last one, or LB_ANY_GEN. */
+static bool lb_copy_snapshot(FILE *out, uint64_t *folded) {
+    *folded = LB_ANY_GEN;
+    FILE *in = fopen(LB_FILE, "rb");
+    if (!in) return errno == ENOENT;
+    char line[512];
+    bool line_start = true;
+    while (fgets(line, sizeof line, in)) {
+        size_t L = strlen(line);
+        bool marker = line_start && strncmp(line, "#folded ", 8) == 0;
+        if (marker) *folded = strtoull(line + 8, NULL, 10);
+        else fputs(line, out);
+        line_start = L && line[L-1] == '\n';
+    }
+    if (!line_start) fputc('\n', out);
+    bool ok = !ferror(in) && !ferror(out);
+    fclose(in);
+    return ok;
+}
+
+/* CSV mode: the file as it is now (other processes may have added to
+   it) followed by our new entries, published through a temporary file. */
+static bool lb_merge_csv(const LBEntry *adds, size_t n) {
+    FILE *out = fopen(LB_TMP_FILE, "wb");
+    if (!out) return false;
+    uint64_t folded;
+    bool ok = lb_copy_snapshot(out, &folded);
+    for (size_t i = 0; ok && i < n; ++i) lb_write_entry(out, &adds[i]);
+    if (!lb_close_file(out, true)) ok = false;
+    if (!ok || !lb_replace_file(LB_TMP_FILE, LB_FILE)) { remove(LB_TMP_FILE); return false; }
+    return true;
+}
+
+/* Journal mode: fold the journal into a new snapshot, the one on disk
+   plus every journal record, marked as holding the journal's generation
+   ("#folded <gen>" in a CSV, the header of a binary one). Then the
+   journal moves to LB_JOURNAL_PREV and the next generation starts. If a
+   crash came between the two, the mark says the journal is in the
+   snapshot already and only the move is redone. */
+static bool lb_fold_csv(LBJournalScan *js, bool *have) {
+    FILE *out = fopen(LB_TMP_FILE, "wb");
+    if (!out) return false;
+    uint64_t folded;
+    bool ok = lb_copy_snapshot(out, &folded);
+    *have = ok && lb_scan_journal(LB_JOURNAL_FILE, LB_ANY_GEN, 0, lb_emit, out, js);
+    if (!*have || js->gen == folded) {
+        fclose(out);
+        remove(LB_TMP_FILE);
+        return ok;
+    }
+    fprintf(out, "#folded %llu\n", (unsigned long long)js->gen);
+    if (!lb_close_file(out, true) || !lb_replace_file(LB_TMP_FILE, LB_FILE)) {
+        remove(LB_TMP_FILE);
+        return false;
+    }
+    return true;
+}
+
+/* entries gathered from a journal or CSV for a binary fold */
+typedef struct {
+    LBEntry *v;
+    size_t n, cap;
+    bool failed;
+} LBList;
+
+static void lb_collect(const LBEntry *e, void *arg) {
+    LBList *l = (LBList*)arg;
+    if (l->n == l->cap) {
+        size_t cap = l->cap ? l->cap * 2 : 256;
+        LBEntry *v = (LBEntry*)realloc(l->v, cap * sizeof(LBEntry));
+        if (!v) { l->failed = true; return; }
+        l->v = v;
+        l->cap = cap;
+    }
+    l->v[l->n++] = *e;
+}
 
-    if (lb_used < LB_MAX_ENTRIES) {
-        lb_store[lb_used++] = newe;
-        qsort(lb_store, lb_used, sizeof(LBEntry), lb_cmp);
-        lb_save();
+/* Binary: the journal records are sorted and merged with the old
+   snapshot. With no binary snapshot yet, the CSV one is taken in. */
+static bool lb_fold_bin(LBJournalScan *js, bool *have) {
+    LBList add = { NULL, 0, 0, false };
+    *have = lb_scan_journal(LB_JOURNAL_FILE, LB_ANY_GEN, 0, lb_collect, &add, js);
+    if (!*have) return true;
+    LBMap old = { NULL, 0, false };
+    LBBinHeader h;
+    LBRun run = { NULL, NULL, 0, LB_BIN_VERSION };
+    uint64_t folded = LB_ANY_GEN;
+    bool ok = !add.failed;
+    if (ok && lb_map_open(LB_BIN_FILE, &old)) {
+        run.records = lb_bin_records(old.base, old.len, &h);
+        if (run.records) { run.n = (size_t)h.count; run.version = h.version; folded = h.folded; }
+        else ok = false;    /* not ours to overwrite */
+    } else if (ok) {
+        FILE *in = fopen(LB_FILE, "rb");
+        char line[512];
+        while (in && fgets(line, sizeof line, in)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            LBEntry e;
+            if (strncmp(line, "#folded ", 8) == 0) folded = strtoull(line + 8, NULL, 10);
+            else if (lb_parse_entry(line, &e)) lb_collect(&e, &add);
+        }
+        if (in) fclose(in);
+        ok = !add.failed;
+    }
+    if (ok && js->gen != folded) {
+        ok = lb_write_bin(LB_TMP_FILE, &run, add.v, add.n, js->gen) &&
+             lb_replace_file(LB_TMP_FILE, LB_BIN_FILE);
+        if (!ok) remove(LB_TMP_FILE);
+    }
+    lb_map_close(&old);
+    free(add.v);
+    return ok;
+}
+
+static bool lb_fold_journal(void) {
+    LBJournalScan js;
+    bool have = false;
+    bool ok = lb_opt.binary ? lb_fold_bin(&js, &have) : lb_fold_csv(&js, &have);
+    if (!ok || !have) return ok;        /* no journal yet: nothing to fold */
+    if (!lb_replace_file(LB_JOURNAL_FILE, LB_JOURNAL_PREV)) return false;
+    FILE *j = lb_reset_journal(js.gen + 1);
+    return j && lb_close_file(j, true);
+}
+
+/* fsync the journal if there is one */
+static bool lb_sync_journal(void) {
+    FILE *f = fopen(LB_JOURNAL_FILE, "r+b");
+    if (!f) return errno == ENOENT;
+    return lb_close_file(f, true);
+}
+
+/* wall clock in ms (the clock pthread_cond_timedwait waits on) */
+static uint64_t lb_now_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* whether a write made now should also be synced */
+static bool lb_sync_due(uint64_t now) {
+    switch (lb_opt.durability) {
+    case LB_DURABLE_EACH:     return true;
+    case LB_DURABLE_PERIODIC: return now >= lb_last_sync + lb_opt.interval_ms;
+    default:                  return false;
+    }
+}
+
+/* One round of file work. lb_take_work claims it (under the lock),
+   lb_do_work does the I/O (without it), lb_finish_work records the
+   outcome (under the lock again). */
+typedef struct {
+    LBEntry *adds;          /* journal records to append */
+    size_t   nadds, cap;
+    LBEntry **chunks;       /* chunk directory copy, for rewrite or compact */
+    size_t   nchunks;       /* room in chunks */
+    size_t   ntable;        /* slots to write */
+    size_t   sorted;        /* slots below this are in rank order */
+    bool     snap_failed;   /* could not copy the directory */
+    bool     rewrite;       /* CSV mode: rewrite the file from table */
+    bool     compact;       /* journal mode: new snapshot from table (shared: fold the journal) */
+    bool     sync;
+    uint64_t now;
+    uint64_t gen;           /* journal generation */
+} LBWork;
+
+static bool lb_has_work(bool final) {
+    return lb_dirty || lb_pending_len ||
+           (final && (lb_unsynced || (lb_journal_records && !lb_opt.shared)));
+}
+
+static void lb_take_work(LBWork *w, bool final) {
+    w->now = lb_now_ms();
+    w->sync = final || lb_sync_due(w->now);
+    w->nadds = 0;
+    w->rewrite = w->compact = false;
+    w->gen = lb_journal_gen;
+    if (lb_opt.journal || lb_opt.shared) {
+        /* swap buffers: the pending records become this round's */
+        LBEntry *t = w->adds; size_t c = w->cap;
+        w->adds = lb_pending; w->nadds = lb_pending_len; w->cap = lb_pending_cap;
+        lb_pending = t; lb_pending_len = 0; lb_pending_cap = c;
+    }
+    if (lb_opt.shared) {
+        /* only files are merged: no table snapshot. A CSV merge is always
+           synced, as it replaces the file. */
+        w->compact = lb_opt.journal && lb_journal_records + w->nadds >= lb_opt.compact_after;
+        if (!lb_opt.journal) w->sync = true;
+        lb_inflight = w->adds;
+        lb_inflight_len = w->nadds;
+        lb_dirty = false;
+        w->snap_failed = false;
+        return;
+    }
+    if (lb_opt.journal)
+        w->compact = final || lb_dirty || lb_journal_records + w->nadds >= lb_opt.compact_after;
+    else
+        w->rewrite = lb_dirty || (final && lb_unsynced);
+    lb_dirty = false;
+    w->snap_failed = false;
+    if (w->rewrite || w->compact) {
+        size_t need = (lb_used + LB_CHUNK - 1) / LB_CHUNK;
+        if (need > w->nchunks) {
+            LBEntry **c = (LBEntry**)realloc(w->chunks, need * sizeof(LBEntry*));
+            if (!c) { w->snap_failed = true; return; }
+            w->chunks = c;
+            w->nchunks = need;
+        }
+        if (need) memcpy(w->chunks, lb_chunks, need * sizeof(LBEntry*));
+        w->ntable = lb_used;
+        w->sorted = lb_sorted_len;
+    }
+}
+
+static void lb_lock_store(void) {
+#ifndef LB_NO_THREADS
+    if (lb_writer_running) pthread_mutex_lock(&lb_mutex);
+#endif
+}
+
+static void lb_unlock_store(void) {
+#ifndef LB_NO_THREADS
+    if (lb_writer_running) pthread_mutex_unlock(&lb_mutex);
+#endif
+}
+
+/* our records are in the files now: until read back they are unseen */
+static void lb_note_written(const LBEntry *adds, size_t n) {
+    if (lb_unseen_len + n > lb_unseen_cap) {
+        size_t cap = lb_unseen_cap ? lb_unseen_cap : 16;
+        while (cap < lb_unseen_len + n) cap *= 2;
+        LBEntry *u = (LBEntry*)realloc(lb_unseen, cap * sizeof(LBEntry));
+        if (!u) { lb_unseen_lost = true; return; }
+        lb_unseen = u;
+        lb_unseen_cap = cap;
+    }
+    memcpy(lb_unseen + lb_unseen_len, adds, n * sizeof(LBEntry));
+    lb_unseen_len += n;
+}
+
+/* shared mode: the same work on the files, under the exclusive lock;
+   the journal is opened per round, as another process may replace it */
+static bool lb_do_shared_work(LBWork *w) {
+    int lock = lb_file_lock(true, true);
+    if (lock < 0) return false;
+    bool ok = true;
+    if (!lb_opt.journal) {
+        if (w->nadds) ok = lb_merge_csv(w->adds, w->nadds);
+    } else if (w->nadds) {
+        FILE *f = lb_open_journal(w->gen);
+        ok = f && lb_write_journal(f, w->adds, w->nadds);
+        if (f && !lb_close_file(f, w->sync)) ok = false;
+    } else if (w->sync) {
+        ok = lb_sync_journal();
+    }
+    if (ok && w->nadds) {
+        /* before anyone can read them back, still under the file lock */
+        lb_lock_store();
+        lb_note_written(w->adds, w->nadds);
+        lb_inflight_len = 0;
+        lb_unlock_store();
+    }
+    /* the records are in; a fold that fails is retried once more arrive */
+    if (ok && w->compact && !lb_fold_journal()) w->compact = false;
+    lb_file_unlock(lock);
+    return ok;
+}
+
+static bool lb_do_work(LBWork *w) {
+    if (lb_opt.shared) return lb_do_shared_work(w);
+    if (w->snap_failed) return false;
+    bool ok = true;
+    if (w->nadds) ok = lb_append_journal(w->adds, w->nadds, w->sync && !w->compact, w->gen);
+    /* a snapshot holding the appended records makes them durable anyway */
+    if (ok && w->compact) ok = lb_compact(w->chunks, w->ntable, w->sorted, w->gen);
+    if (ok && w->rewrite) ok = lb_write_file(LB_FILE, w->chunks, w->ntable, LB_ANY_GEN, w->sync);
+    return ok;
+}
+
+static void lb_finish_work(LBWork *w, bool ok) {
+    lb_inflight_len = 0;
+    if (!ok) {
+        /* keep the work for a retry: records go back in front of newer ones,
+           a failed rewrite or snapshot is simply due again */
+        if (w->nadds) {
+            size_t need = w->nadds + lb_pending_len;
+            if (need > lb_pending_cap) {
+                LBEntry *p = (LBEntry*)realloc(lb_pending, need * sizeof(LBEntry));
+                if (!p) { lb_dirty = true; return; }    /* the next snapshot has them */
+                lb_pending = p;
+                lb_pending_cap = need;
+            }
+            memmove(lb_pending + w->nadds, lb_pending, lb_pending_len * sizeof(LBEntry));
+            memcpy(lb_pending, w->adds, w->nadds * sizeof(LBEntry));
+            lb_pending_len = need;
+        }
+        if (w->rewrite || w->compact) lb_dirty = true;
+        return;
+    }
+    if (w->compact) {
+        lb_journal_records = 0;
+        if (!lb_opt.shared) lb_journal_gen = w->gen + 1;   /* shared: seen on refresh */
+        lb_unsynced = false;
+        lb_last_sync = w->now;
+        return;
+    }
+    if (!lb_opt.shared) lb_journal_records += w->nadds;
+    if (w->nadds || w->rewrite) lb_unsynced = !w->sync;
+    else if (w->sync && lb_opt.shared) lb_unsynced = false;    /* journal synced by itself */
+    if (w->sync) lb_last_sync = w->now;
+}
+
+/* synchronous mode, and shutdown without a writer: one round inline */
+static void lb_save(bool final) {
+    if (!lb_has_work(final)) return;
+    LBWork w;
+    memset(&w, 0, sizeof w);
+    lb_take_work(&w, final);
+    lb_finish_work(&w, lb_do_work(&w));
+    free(w.adds);
+    free(w.chunks);
+}
+
+#ifndef LB_NO_THREADS
+
+/* Background writer: sleeps until there is something to write, then does
+   one round of work with the lock released. Submissions arriving during
+   a round just queue up (or mark the table dirty again), so a burst costs
+   one more round, not one each. Under LB_DURABLE_PERIODIC it waits out
+   the interval first and every round is synced. */
+static void *lb_writer_main(void *arg) {
+    (void)arg;
+    static LBWork w;
+    pthread_mutex_lock(&lb_mutex);
+    for (;;) {
+        if (!lb_stopping && !lb_has_work(false)) {
+            pthread_cond_wait(&lb_wake, &lb_mutex);
+            continue;
+        }
+        if (!lb_stopping && lb_opt.durability == LB_DURABLE_PERIODIC && !lb_sync_due(lb_now_ms())) {
+            uint64_t due = lb_last_sync + lb_opt.interval_ms;
+            struct timespec until = { (time_t)(due / 1000), (long)(due % 1000) * 1000000L };
+            pthread_cond_timedwait(&lb_wake, &lb_mutex, &until);
+            continue;
+        }
+        if (!lb_has_work(lb_stopping)) break;   /* stopping, nothing left */
+
+        lb_take_work(&w, lb_stopping);
+        pthread_mutex_unlock(&lb_mutex);
+        bool ok = lb_do_work(&w);
+        pthread_mutex_lock(&lb_mutex);
+        lb_finish_work(&w, ok);
+
+        if (!ok) {
+            if (lb_stopping) break;         /* give up rather than spin at exit */
+            /* wait for the next submission before retrying */
+            pthread_cond_wait(&lb_wake, &lb_mutex);
+            continue;
+        }
+        if (lb_stopping && !lb_has_work(true)) break;
+    }
+    pthread_mutex_unlock(&lb_mutex);
+    free(w.adds);
+    free(w.chunks);
+    memset(&w, 0, sizeof w);
+    return NULL;
+}
+
+#endif
+
+void lb_configure(const LBPersistOptions *opt) {
+    lb_opt = *opt;
+    if (lb_opt.interval_ms == 0) lb_opt.interval_ms = 1;
+    if (lb_opt.compact_after == 0) lb_opt.compact_after = 1;
+    if (lb_opt.binary) lb_opt.journal = true;
+}
+
+/* Read the table from the files: the snapshot, then the journal on top.
+   Entries of ours not written yet go back in. */
+static void lb_reload(void) {
+    lb_unseen_len = 0;
+    lb_unseen_lost = false;
+    lb_seen_off = lb_load();
+    lb_journal_records = 0;
+    if (lb_opt.journal) {
+        LBJournalScan js;
+        if (lb_scan_journal(LB_JOURNAL_FILE, LB_ANY_GEN, 0, lb_apply_unfolded, &js, &js)) {
+            lb_journal_gen = js.gen;
+            lb_seen_off = js.end;
+            lb_journal_records = js.records;
+        } else {
+            lb_journal_gen = 0;
+            lb_seen_off = 0;
+        }
+    }
+    for (size_t i = 0; i < lb_pending_len; ++i) lb_insert(&lb_pending[i]);
+    for (size_t i = 0; i < lb_inflight_len; ++i) lb_insert(&lb_inflight[i]);
+}
+
+/* shared mode: the file followed for changes, and its state when last read */
+static const char *lb_followed(void) { return lb_opt.journal ? LB_JOURNAL_FILE : LB_FILE; }
+static LBFileSig lb_seen_sig;
+
+/* Bring the table up to date with the files by reading only what was
+   added since; false if that is not possible and a reload is needed. */
+static bool lb_catch_up(void) {
+    if (!lb_opt.journal) {
+        /* merges keep the old file as a prefix of the new one */
+        if (!lb_seen_sig.exists || lb_seen_sig.size < lb_seen_off) return false;
+        long end = lb_read_snapshot(LB_FILE, lb_seen_off, true);
+        if (end < 0) return false;
+        lb_seen_off = end;
         return true;
     }
-    /* leaderboard full: compare with worst (last item after sort) */
-    if (lb_cmp(&newe, &lb_store[lb_used - 1]) < 0) {
-        lb_store[lb_used - 1] = newe;
-        qsort(lb_store, lb_used, sizeof(LBEntry), lb_cmp);
-        lb_save();
+    LBJournalScan js;
+    if (lb_scan_journal(LB_JOURNAL_FILE, lb_journal_gen, lb_seen_off, lb_apply, NULL, &js)) {
+        lb_seen_off = js.end;
+        lb_journal_records += js.records;
         return true;
     }
-    return false;
+    /* folded since: finish our generation in the previous journal, then
+       read the next one from the top (folded twice: reload) */
+    if (!lb_scan_journal(LB_JOURNAL_PREV, lb_journal_gen, lb_seen_off, lb_apply, NULL, &js) ||
+        !lb_scan_journal(LB_JOURNAL_FILE, lb_journal_gen + 1, 0, lb_apply, NULL, &js))
+        return false;
+    lb_journal_gen = js.gen;
+    lb_seen_off = js.end;
+    lb_journal_records = js.records;
+    return true;
+}
+
+/* Called from game loops, so it never waits for the file lock: while
+   another process is writing, the table stays as it is and the next
+   call looks again. */
+void lb_refresh(void) {
+    if (!lb_opt.shared) return;
+    LBFileSig sig;
+    lb_file_sig(lb_followed(), &sig);
+    if (lb_sig_equal(&sig, &lb_seen_sig)) return;   /* our own writes change it too */
+    int lock = lb_file_lock(false, false);
+    if (lock == LB_LOCK_BUSY) return;
+    lb_lock_store();
+    lb_file_sig(lb_followed(), &lb_seen_sig);   /* steady while we hold the lock */
+    if (lb_unseen_lost || !lb_catch_up()) lb_reload();
+    lb_unlock_store();
+    lb_file_unlock(lock);
+}
+
+void lb_init(void) {
+    int lock = lb_opt.shared ? lb_file_lock(false, true) : -1;
+    lb_dirty = lb_unsynced = false;
+    lb_pending_len = lb_inflight_len = 0;
+    lb_reload();
+    if (lb_opt.shared) lb_file_sig(lb_followed(), &lb_seen_sig);
+    lb_file_unlock(lock);
+    lb_last_sync = lb_now_ms();
+#ifndef LB_NO_THREADS
+    if (lb_opt.async && !lb_writer_running)
+        lb_writer_running = pthread_create(&lb_writer, NULL, lb_writer_main, NULL) == 0;
+#endif
+}
+
+void lb_shutdown(void) {
+#ifndef LB_NO_THREADS
+    if (lb_writer_running) {
+        pthread_mutex_lock(&lb_mutex);
+        lb_stopping = true;
+        pthread_cond_signal(&lb_wake);
+        pthread_mutex_unlock(&lb_mutex);
+        pthread_join(lb_writer, NULL);
+        lb_writer_running = false;
+        lb_stopping = false;
+    }
+#endif
+    lb_save(true);      /* whatever the writer could not finish */
+    if (lb_journal) { fclose(lb_journal); lb_journal = NULL; }
+    lb_free_table();
+    free(lb_pending);
+    lb_pending = NULL;
+    lb_pending_len = lb_pending_cap = 0;
+    free(lb_unseen);
+    lb_unseen = NULL;
+    lb_unseen_len = lb_unseen_cap = 0;
+}
+
+/* e was just accepted: queue it for the journal or a shared merge (or
+   mark the table for a rewrite), and write now or hand it to the writer */
+static void lb_changed(const LBEntry *e) {
+    if (lb_opt.journal || lb_opt.shared) {
+        if (lb_pending_len == lb_pending_cap) {
+            size_t cap = lb_pending_cap ? lb_pending_cap * 2 : 16;
+            LBEntry *p = (LBEntry*)realloc(lb_pending, cap * sizeof(LBEntry));
+            if (p) { lb_pending = p; lb_pending_cap = cap; }
+        }
+        if (lb_pending_len < lb_pending_cap) lb_pending[lb_pending_len++] = *e;
+        else lb_dirty = true;   /* no room to queue it: snapshot instead */
+    } else {
+        lb_dirty = true;
+    }
+#ifndef LB_NO_THREADS
+    if (lb_writer_running) { pthread_cond_signal(&lb_wake); return; }
+#endif
+    lb_save(false);
+}
+
+bool lb_add(const char *name, const char *puzzle, int solved, int time_sec, size_t *rank) {
+    if (!name || name[0] == '\0') return false;
+    LBEntry newe;
+    lb_copy_field(newe.name, name, LB_NAME_LEN);
+    newe.solved = solved; newe.time_sec = time_sec; newe.when = time(NULL);
+    lb_copy_field(newe.puzzle, puzzle, LB_PUZZLE_LEN);
+
+    lb_lock_store();
+    bool added = lb_insert(&newe);
+    if (added) lb_changed(&newe);
+    lb_unlock_store();
+    if (added && rank) *rank = lb_count_better(&lb_all, &newe) + 1;
+    return added;
 }
 
 size_t lb_count(void) { return lb_used; }
-const LBEntry *lb_get_entries(void) { return lb_store; }
 
-void lb_print_top(size_t n) {
+size_t lb_range(size_t start, size_t n, LBEntry *out) {
+    return lb_view_range(LB_ALL_TIME, NULL, start, n, out);
+}
+
+size_t lb_view_count(LBWindow w, const char *puzzle) {
+    return lb_view_tree(w, puzzle)->n;
+}
+
+size_t lb_view_range(LBWindow w, const char *puzzle, size_t start, size_t n, LBEntry *out) {
+    const LBTree *t = lb_view_tree(w, puzzle);
+    LBIter it;
+    lb_iter_seek(&it, t, start);
+    size_t k = 0;
+    for (uint32_t i; k < n && (i = lb_iter_next(&it)) != LB_NIL; ) out[k++] = *LB_AT(i);
+    return k;
+}
+
+static const LBPlayer *lb_player(const char *name) {
+    if (lb_names_cap == 0) return NULL;
+    const LBPlayer *p = &lb_names[lb_name_find(name)];
+    return p->best == LB_NIL ? NULL : p;
+}
+
+bool lb_player_best(const char *name, LBEntry *out, size_t *rank) {
+    const LBPlayer *p = lb_player(name);
+    if (!p) return false;
+    if (out) *out = *LB_AT(p->best);
+    if (rank) *rank = lb_count_better(&lb_all, LB_AT(p->best)) + 1;
+    return true;
+}
+
+bool lb_player_stats(const char *name, LBPlayerStats *out) {
+    const LBPlayer *p = lb_player(name);
+    if (!p) return false;
+    out->best = *LB_AT(p->best);
+    out->rank = lb_count_better(&lb_all, LB_AT(p->best)) + 1;
+    out->plays = p->plays;
+    out->avg_solved = (double)p->sum_solved / p->plays;
+    out->avg_time_sec = (double)p->sum_time / p->plays;
+    return true;
+}
+
+static bool lb_is_csv(const char *path) {
+    size_t n = strlen(path);
+    return n >= 4 && strcmp(path + n - 4, ".csv") == 0;
+}
+
+bool lb_convert(const char *from, const char *to, size_t *count) {
+    lb_free_table();
+    lb_snapshot_folded = LB_ANY_GEN;
+    bool ok = lb_is_csv(from) ? lb_read_snapshot(from, 0, false) >= 0 : lb_load_bin(from);
+    if (ok) {
+        /* the mark of a folded journal goes along, so it is not taken in twice */
+        if (lb_is_csv(to)) ok = lb_write_file(to, lb_chunks, lb_used, lb_snapshot_folded, true);
+        else ok = lb_write_bin_table(to, lb_chunks, lb_used, lb_sorted_len, lb_snapshot_folded);
+        if (count) *count = lb_used;
+    }
+    lb_free_table();
+    return ok;
+}
+
+void lb_render_view(LBWindow w, const char *puzzle, size_t start, size_t n, FrameBuf *fb) {
+    const LBTree *t = lb_view_tree(w, puzzle);
+    size_t total = t->n;
+    /* "Leaderboard", "Leaderboard: today", "Leaderboard: this week, <puzzle>" */
+    char title[LB_PUZZLE_LEN + 32] = "Leaderboard";
+    const char *sep = ": ";
+    if (w != LB_ALL_TIME) {
+        snprintf(title + strlen(title), sizeof title - strlen(title), "%s%s", sep,
+                 w == LB_TODAY ? "today" : "this week");
+        sep = ", ";
+    }
+    if (puzzle && puzzle[0]) snprintf(title + strlen(title), sizeof title - strlen(title), "%s%s", sep, puzzle);
     if (n == 0) return;
-    if (n > lb_used) n = lb_used;
-    printf("\n--- Leaderboard (top %zu) ---\n", n);
-    printf("%-3s %-20s %-6s %-8s %-20s\n", "#", "NAME", "SOLVED", "TIME(s)", "DATE");
+    if (start > total) start = total;
+    if (n > total - start) n = total - start;
+    if (start == 0) fb_printf(fb, "\n--- %s (top %zu) ---\n", title, n);
+    else if (n == 0) {
+        if (w == LB_ALL_TIME && !(puzzle && puzzle[0])) fb_printf(fb, "\nThe leaderboard has only %zu entries.\n", total);
+        else fb_printf(fb, "\n%s has only %zu entries.\n", title, total);
+        return;
+    }
+    else fb_printf(fb, "\n--- %s (#%zu-#%zu of %zu) ---\n", title, start + 1, start + n, total);
+    fb_printf(fb, "%-3s %-20s %-6s %-8s %-20s\n", "#", "NAME", "SOLVED", "TIME(s)", "DATE");
+    LBIter it;
+    lb_iter_seek(&it, t, start);
     for (size_t i = 0; i < n; ++i) {
+        uint32_t k = lb_iter_next(&it);
+        const LBEntry *e = LB_AT(k);
         char tbuf[32] = "unknown";
         struct tm tmp;
-        struct tm *ptm = localtime(&lb_store[i].when);
+        struct tm *ptm = localtime(&e->when);
         if (ptm) { tmp = *ptm; strftime(tbuf, sizeof tbuf, "%Y-%m-%d", &tmp); }
-        printf("%-3zu %-20s %-6d %-8d %-20s\n",
-               i + 1, lb_store[i].name, lb_store[i].solved, lb_store[i].time_sec, tbuf);
+        fb_printf(fb, "%-3zu %-20s %-6d %-8d %-20s\n",
+                  start + i + 1, e->name, e->solved, e->time_sec, tbuf);
     }
 }
 
+void lb_render_range(size_t start, size_t n, FrameBuf *fb) {
+    lb_render_view(LB_ALL_TIME, NULL, start, n, fb);
+}
+
+void lb_render_top(size_t n, FrameBuf *fb) {
+    lb_render_range(0, n, fb);
+}
+
+void lb_print_top(size_t n) {
+    FrameBuf fb;
+    fb_init(&fb);
+    lb_render_top(n, &fb);
+    fb_flush(&fb, stdout);
+    fb_free(&fb);
+}
+
 void lb_print_all(void) {
     lb_print_top(lb_used);
 }
@@ -4,28 +4,90 @@
 #include <time.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "render.h"
 
 #define LB_NAME_LEN 32
+#define LB_PUZZLE_LEN 32
 #define LB_FILE "leaderboard.csv"
-#define LB_MAX_ENTRIES 128
+#define LB_JOURNAL_FILE "leaderboard.journal"
+#define LB_BIN_FILE "leaderboard.bin"   /* binary snapshot, see LBPersistOptions.binary */
 
 typedef struct {
     char name[LB_NAME_LEN];
     int solved;         /* number of words solved */
     int time_sec;       /* time taken in seconds */
     time_t when;        /* timestamp */
+    char puzzle[LB_PUZZLE_LEN];  /* title of the puzzle played, "" if unknown */
 } LBEntry;
 
+/* Which entries a ranking covers; day and week are the current local
+   calendar ones (weeks start on Monday) */
+typedef enum {
+    LB_ALL_TIME,
+    LB_TODAY,
+    LB_THIS_WEEK,
+    LB_WINDOWS
+} LBWindow;
+
+typedef struct {
+    LBEntry best;
+    size_t rank;            /* of best, overall */
+    size_t plays;           /* entries recorded */
+    double avg_solved, avg_time_sec;
+} LBPlayerStats;
+
+/* When the file is forced to disk (fsync) after being rewritten */
+typedef enum {
+    LB_DURABLE_EACH,        /* every write */
+    LB_DURABLE_PERIODIC,    /* at most once per interval_ms; writes wait for it */
+    LB_DURABLE_SHUTDOWN     /* only by lb_shutdown */
+} LBDurability;
+
+typedef struct {
+    bool async;             /* write from a background thread; lb_add never touches the disk */
+    LBDurability durability;
+    unsigned interval_ms;   /* for LB_DURABLE_PERIODIC */
+    bool journal;           /* append each entry to LB_JOURNAL_FILE instead of rewriting
+                               LB_FILE, which becomes a snapshot */
+    size_t compact_after;   /* journal records before a new snapshot is taken */
+    bool binary;            /* journal mode with the snapshot in LB_BIN_FILE: fixed-size
+                               records in rank order, mapped at startup instead of
+                               parsed (read from LB_FILE until the first one exists) */
+    bool shared;            /* other processes use the same files: writes merge with
+                               what is on disk under a file lock, lb_refresh reads
+                               what they added */
+} LBPersistOptions;
+
 /* lifecycle */
-void lb_init(void);
-void lb_shutdown(void);
+void lb_configure(const LBPersistOptions *opt);   /* before lb_init; default: synchronous CSV, each */
+void lb_init(void);         /* loads the snapshot and replays the journal */
+void lb_shutdown(void);     /* writes anything pending, syncs it and stops the writer */
+void lb_refresh(void);      /* shared: take in entries other processes wrote (cheap if none;
+                               skipped, never waited for, while one of them is writing) */
 
-/* operations */
-bool lb_add(const char *name, int solved, int time_sec);
+/* operations (every entry is kept; ranks count from 1, ties share one) */
+bool lb_add(const char *name, const char *puzzle, int solved, int time_sec, size_t *rank);
+                            /* puzzle may be NULL; rank (overall) may be NULL */
 size_t lb_count(void);
-const LBEntry *lb_get_entries(void);
+size_t lb_range(size_t start, size_t n, LBEntry *out);  /* rank order from 0-based start; count copied */
+bool lb_player_best(const char *name, LBEntry *out, size_t *rank);    /* false if no entries */
+bool lb_player_stats(const char *name, LBPlayerStats *out);           /* false if no entries */
+
+/* Rankings within a window and/or of one puzzle (NULL or "": every
+   puzzle); each is kept as entries arrive, so these cost what the
+   overall ones do. */
+size_t lb_view_count(LBWindow w, const char *puzzle);
+size_t lb_view_range(LBWindow w, const char *puzzle, size_t start, size_t n, LBEntry *out);
+
+/* Convert a snapshot file between CSV and the binary format, each
+   chosen by its path (".csv" or not). Uses the leaderboard's table, so
+   it is for tools that do not lb_init. */
+bool lb_convert(const char *from, const char *to, size_t *count);
 
 /* utilities */
+void lb_render_top(size_t n, FrameBuf *fb);   /* append instead of printing */
+void lb_render_range(size_t start, size_t n, FrameBuf *fb);
+void lb_render_view(LBWindow w, const char *puzzle, size_t start, size_t n, FrameBuf *fb);
 void lb_print_top(size_t n);
 void lb_print_all(void);
 
@@ -0,0 +1,260 @@
+// loadclient.c - load generator for the game server (crossword --serve)
+//
+//   gcc -std=c11 -Wall -Wextra -O2 loadclient.c -o loadclient
+//   ./loadclient unix:/tmp/crossword.sock -c 2000 -n 200
+//
+// Opens many connections at once and drives each through a script of
+// commands, one at a time: a command is sent, and the reply counts as
+// complete when the server's "> " prompt comes back. Reports throughput
+// and reply latency percentiles. Linux only (epoll).
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEFAULT_SCRIPT "progress;clues;guess 1 ZZZZ;show;leaderboard 5"
+#define MAX_COMMANDS   64
+
+typedef struct {
+    int      fd;
+    size_t   done;          // replies received to scripted commands
+    size_t   next_cmd;      // script position
+    char     tail[3];       // last bytes received, to spot "\n> "
+    uint64_t sent_at;       // ns timestamp of the command in flight, 0 if none
+    const char *pending;    // unsent part of the command in flight
+    size_t   pending_len;
+    bool     ready;         // banner and first prompt received
+} Client;
+
+static const char *commands[MAX_COMMANDS];
+static size_t command_lens[MAX_COMMANDS];
+static size_t command_count;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* split "a;b;c" into newline-terminated commands */
+static bool parse_script(const char *script) {
+    size_t len = strlen(script);
+    char *buf = (char*)malloc(len + 2);
+    if (!buf) return false;
+    command_count = 0;
+    const char *p = script;
+    char *q = buf;
+    while (*p && command_count < MAX_COMMANDS) {
+        size_t n = strcspn(p, ";");
+        if (n) {
+            commands[command_count] = q;
+            memcpy(q, p, n);
+            q[n] = '\n';
+            command_lens[command_count++] = n + 1;
+            q += n + 1;
+        }
+        p += n;
+        if (*p == ';') ++p;
+    }
+    return command_count > 0;
+}
+
+/* ---------------- Connecting ---------------- */
+
+static int connect_to(const char *addr) {
+    int fd = -1;
+    if (strncmp(addr, "unix:", 5) == 0) {
+        struct sockaddr_un sa;
+        memset(&sa, 0, sizeof sa);
+        sa.sun_family = AF_UNIX;
+        if (strlen(addr + 5) >= sizeof sa.sun_path) return -1;
+        strcpy(sa.sun_path, addr + 5);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&sa, sizeof sa) != 0) { close(fd); fd = -1; }
+    } else {
+        char host[256] = "127.0.0.1";
+        const char *port = strrchr(addr, ':');
+        if (port) {
+            size_t n = (size_t)(port - addr);
+            if (n && addr[0] == '[' && addr[n - 1] == ']') { ++addr; n -= 2; }
+            if (n >= sizeof host) return -1;
+            if (n) { memcpy(host, addr, n); host[n] = '\0'; }
+            ++port;
+        } else {
+            port = addr;
+        }
+        struct addrinfo hints, *res, *ai;
+        memset(&hints, 0, sizeof hints);
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+        for (ai = res; ai && fd < 0; ai = ai->ai_next) {
+            fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) { close(fd); fd = -1; }
+        }
+        freeaddrinfo(res);
+    }
+    /* connect blocking (it waits out a full accept queue), then switch */
+    if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+/* ---------------- Driving a client ---------------- */
+
+static bool send_pending(int epfd, Client *c) {
+    while (c->pending_len) {
+        ssize_t n = send(c->fd, c->pending, c->pending_len, MSG_NOSIGNAL);
+        if (n > 0) { c->pending += n; c->pending_len -= (size_t)n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct epoll_event ev = { .events = EPOLLIN | EPOLLOUT, .data.ptr = c };
+            return epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev) == 0;
+        }
+        return false;
+    }
+    return true;
+}
+
+static bool send_next(int epfd, Client *c) {
+    size_t k = c->next_cmd++ % command_count;
+    c->pending = commands[k];
+    c->pending_len = command_lens[k];
+    c->sent_at = now_ns();
+    return send_pending(epfd, c);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(void) {
+    fputs("usage: loadclient <unix:/path | [host:]port> [-c connections] [-n commands-per-connection]\n"
+          "                  [-s \"cmd;cmd;...\"]   (default script: " DEFAULT_SCRIPT ")\n", stderr);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) { usage(); return 1; }
+    const char *addr = argv[1];
+    size_t nconn = 1000, per_conn = 100;
+    const char *script = DEFAULT_SCRIPT;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) nconn = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) per_conn = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) script = argv[++i];
+        else { usage(); return 1; }
+    }
+    if (nconn == 0 || per_conn == 0 || !parse_script(script)) { usage(); return 1; }
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    Client *clients = (Client*)calloc(nconn, sizeof(Client));
+    uint32_t *lat_us = (uint32_t*)malloc(nconn * per_conn * sizeof(uint32_t));
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (!clients || !lat_us || epfd < 0) { fputs("loadclient: out of memory\n", stderr); return 1; }
+
+    uint64_t t0 = now_ns();
+    size_t open_count = 0;
+    for (size_t i = 0; i < nconn; ++i) {
+        Client *c = &clients[i];
+        c->fd = connect_to(addr);
+        if (c->fd < 0) {
+            fprintf(stderr, "loadclient: connection %zu to %s failed: %s\n", i + 1, addr, strerror(errno));
+            break;
+        }
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+        ++open_count;
+    }
+    if (open_count == 0) return 1;
+    uint64_t t_connected = now_ns();
+
+    size_t nlat = 0, active = open_count, errors = 0;
+    struct epoll_event ev[256];
+    char buf[16384];
+    while (active) {
+        int n = epoll_wait(epfd, ev, 256, 10000);
+        if (n < 0) { if (errno == EINTR) continue; perror("epoll_wait"); break; }
+        if (n == 0) { fprintf(stderr, "loadclient: no reply for 10s, giving up\n"); break; }
+        for (int i = 0; i < n; ++i) {
+            Client *c = (Client*)ev[i].data.ptr;
+            bool ok = true;
+            if ((ev[i].events & EPOLLOUT) && c->pending_len) {
+                ok = send_pending(epfd, c);
+                if (ok && !c->pending_len) {
+                    struct epoll_event in = { .events = EPOLLIN, .data.ptr = c };
+                    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &in);
+                }
+            }
+            bool prompt = false;
+            while (ok && (ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                ssize_t r = recv(c->fd, buf, sizeof buf, 0);
+                if (r < 0 && errno == EINTR) continue;
+                if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (r <= 0) { ok = false; break; }
+                /* slide the last three bytes seen */
+                for (ssize_t k = r > 3 ? r - 3 : 0; k < r; ++k) {
+                    c->tail[0] = c->tail[1];
+                    c->tail[1] = c->tail[2];
+                    c->tail[2] = buf[k];
+                }
+                prompt = memcmp(c->tail, "\n> ", 3) == 0;
+            }
+            if (ok && prompt) {
+                if (!c->ready) {
+                    c->ready = true;
+                } else {
+                    lat_us[nlat++] = (uint32_t)((now_ns() - c->sent_at) / 1000);
+                    ++c->done;
+                }
+                if (c->done == per_conn) {
+                    close(c->fd);
+                    c->fd = -1;
+                    --active;
+                    continue;
+                }
+                ok = send_next(epfd, c);
+            }
+            if (!ok) {
+                ++errors;
+                close(c->fd);
+                c->fd = -1;
+                --active;
+            }
+        }
+    }
+    uint64_t t_end = now_ns();
+    for (size_t i = 0; i < open_count; ++i) if (clients[i].fd >= 0) close(clients[i].fd);
+
+    double connect_s = (double)(t_connected - t0) / 1e9;
+    double run_s = (double)(t_end - t_connected) / 1e9;
+    printf("connections: %zu (opened in %.3fs), commands: %zu, errors: %zu\n",
+           open_count, connect_s, nlat, errors + active);
+    if (nlat) {
+        qsort(lat_us, nlat, sizeof *lat_us, cmp_u32);
+        printf("throughput:  %.0f replies/s over %.3fs\n", run_s > 0 ? (double)nlat / run_s : 0.0, run_s);
+        printf("latency us:  p50 %u  p90 %u  p99 %u  max %u\n",
+               lat_us[nlat / 2], lat_us[nlat * 9 / 10], lat_us[nlat * 99 / 100], lat_us[nlat - 1]);
+    }
+    free(lat_us);
+    free(clients);
+    close(epfd);
+    return errors + active ? 1 : 0;
+}
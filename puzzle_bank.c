@@ -0,0 +1,69 @@
+// puzzle_bank.c - source data for the built-in puzzles
+// Compiled into gen_puzzles only; the game links the generated puzzles_gen.c.
+#include "puzzle_bank.h"
+
+/* (same puzzles you used; edit if desired) */
+const Puzzle PUZZLES[] = {
+    { .title = "Programming Basics", .rows = 10, .cols = 10, .count = 8,
+      .entries = {
+        {"CODE",0,0,DIR_ACROSS,"Write-and-compile activity"},
+        {"ARRAY",1,0,DIR_ACROSS,"Indexed collection"},
+        {"DEBUG",2,0,DIR_ACROSS,"Find and fix errors"},
+        {"LOOP",3,0,DIR_ACROSS,"Repeated execution structure"},
+        {"INPUT",4,0,DIR_ACROSS,"What a program reads"},
+        {"OUTPUT",5,0,DIR_ACROSS,"What a program produces"},
+        {"STACK",6,0,DIR_ACROSS,"LIFO data structure"},
+        {"QUEUE",7,0,DIR_ACROSS,"FIFO data structure"}
+      }
+    },
+    { .title = "Languages & Tools", .rows = 10, .cols = 10, .count = 8,
+      .entries = {
+        {"PYTHON",0,0,DIR_ACROSS,"Snake and a language"},
+        {"JAVA",1,0,DIR_ACROSS,"Coffee-named language"},
+        {"RUST",2,0,DIR_ACROSS,"Systems language focused on safety"},
+        {"GIT",3,0,DIR_ACROSS,"Version control tool"},
+        {"DOCKER",4,0,DIR_ACROSS,"Container platform"},
+        {"NPM",5,0,DIR_ACROSS,"Node package manager"},
+        {"REACT",6,0,DIR_ACROSS,"UI library by Meta"},
+        {"BASH",7,0,DIR_ACROSS,"Shell for scripting"}
+      }
+    },
+    { .title = "Computer Science Concepts", .rows = 10, .cols = 10, .count = 8,
+      .entries = {
+        {"ALGORITHM",0,0,DIR_ACROSS,"Step-by-step procedure"},
+        {"COMPLEXITY",1,0,DIR_ACROSS,"Big-O topic"},
+        {"GRAPH",2,0,DIR_ACROSS,"Non-linear structure of nodes"},
+        {"TREE",3,0,DIR_ACROSS,"Acyclic connected graph"},
+        {"HEAP",4,0,DIR_ACROSS,"Priority-based structure"},
+        {"HASH",5,0,DIR_ACROSS,"Maps keys to indices"},
+        {"CACHE",6,0,DIR_ACROSS,"Fast memory for recent data"},
+        {"THREAD",7,0,DIR_ACROSS,"Unit of CPU execution"}
+      }
+    },
+    { .title = "General Knowledge", .rows = 10, .cols = 10, .count = 8,
+      .entries = {
+        {"EARTH",0,0,DIR_ACROSS,"Our home planet"},
+        {"OCEAN",1,0,DIR_ACROSS,"Vast body of salt water"},
+        {"RIVER",2,0,DIR_ACROSS,"Flows to the sea"},
+        {"DESERT",3,0,DIR_ACROSS,"Dry, sandy region"},
+        {"MOUNTAIN",4,0,DIR_ACROSS,"Tall natural elevation"},
+        {"FOREST",5,0,DIR_ACROSS,"Many trees together"},
+        {"ISLAND",6,0,DIR_ACROSS,"Land surrounded by water"},
+        {"VALLEY",7,0,DIR_ACROSS,"Low area between hills"}
+      }
+    },
+    { .title = "Animals & Nature", .rows = 10, .cols = 10, .count = 8,
+      .entries = {
+        {"TIGER",0,0,DIR_ACROSS,"Striped big cat"},
+        {"EAGLE",1,0,DIR_ACROSS,"Majestic bird of prey"},
+        {"WHALE",2,0,DIR_ACROSS,"Largest ocean mammal"},
+        {"PANDA",3,0,DIR_ACROSS,"Bamboo-loving bear"},
+        {"ZEBRA",4,0,DIR_ACROSS,"Black-and-white stripes"},
+        {"HORSE",5,0,DIR_ACROSS,"Ridden by cowboys"},
+        {"CAMEL",6,0,DIR_ACROSS,"Desert ship"},
+        {"OTTER",7,0,DIR_ACROSS,"Playful river mammal"}
+      }
+    }
+};
+
+const size_t PUZZLE_COUNT = sizeof(PUZZLES) / sizeof(PUZZLES[0]);
@@ -0,0 +1,37 @@
+#ifndef PUZZLE_BANK_H
+#define PUZZLE_BANK_H
+
+#include <stddef.h>
+#include "crossword.h"
+
+/* ---------------- Source bank (puzzle_bank.c) ----------------
+   Read only by the gen_puzzles build tool, which places and checks every
+   entry and writes the result out as puzzles_gen.c. */
+
+typedef struct {
+    const char *text;
+    size_t row, col;
+    Direction dir;
+    const char *clue;
+} Entry;
+
+typedef struct {
+    const char *title;
+    size_t rows, cols;
+    size_t count;
+    Entry entries[16];
+} Puzzle;
+
+extern const Puzzle PUZZLES[];
+extern const size_t PUZZLE_COUNT;
+
+/* ---------------- Prebuilt bank (generated puzzles_gen.c) ----------------
+   Fully placed crosswords in static storage (marked prebuilt, so
+   destroy_crossword leaves them alone). They hold no solve state: every
+   player shares them through their own Session. */
+
+extern Crossword PREBUILT_PUZZLES[];
+extern const char *const PREBUILT_TITLES[];
+extern const size_t PREBUILT_COUNT;
+
+#endif
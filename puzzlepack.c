@@ -0,0 +1,239 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "puzzlepack.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define PACK_ALIGN 8u
+
+/* ---------------- Opening ---------------- */
+
+static bool attach(PuzzlePack *pk, const unsigned char *base, size_t len, bool mapped) {
+    PackHeader h;
+    if (len < sizeof h) return false;
+    memcpy(&h, base, sizeof h);
+    if (h.magic != PACK_MAGIC || h.version != PACK_VERSION) return false;
+    if (h.table % PACK_ALIGN || h.table < sizeof h || h.table > len) return false;
+    if ((len - h.table) / sizeof(uint64_t) != (size_t)h.count + 1) return false;
+    pk->base = base;
+    pk->len = len;
+    pk->mapped = mapped;
+    pk->count = h.count;
+    pk->table = (const uint64_t*)(base + h.table);
+    return true;
+}
+
+bool pp_open(const char *path, PuzzlePack *pk) {
+    memset(pk, 0, sizeof *pk);
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    size_t len = (size_t)st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    if (!attach(pk, (const unsigned char*)map, len, true)) { munmap(map, len); return false; }
+    return true;
+#else
+    /* no mmap here: read the file in one go (records are still parsed lazily) */
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    if (fseek(f, 0, SEEK_END) != 0) { fclose(f); return false; }
+    long sz = ftell(f);
+    rewind(f);
+    if (sz <= 0) { fclose(f); return false; }
+    unsigned char *buf = (unsigned char*)malloc((size_t)sz);
+    bool ok = buf && fread(buf, 1, (size_t)sz, f) == (size_t)sz;
+    fclose(f);
+    if (!ok || !attach(pk, buf, (size_t)sz, false)) { free(buf); return false; }
+    return true;
+#endif
+}
+
+void pp_close(PuzzlePack *pk) {
+    if (!pk->base) return;
+#ifndef _WIN32
+    if (pk->mapped) munmap((void*)pk->base, pk->len);
+    else
+#endif
+    free((void*)pk->base);
+    memset(pk, 0, sizeof *pk);
+}
+
+size_t pp_count(const PuzzlePack *pk) {
+    return pk->count;
+}
+
+/* ---------------- Reading one puzzle ---------------- */
+
+/* NUL-terminated string at off inside a span of n bytes; its length or -1 */
+static long str_in(const char *rec, size_t n, uint32_t off) {
+    if (off >= n) return -1;
+    const char *end = (const char*)memchr(rec + off, '\0', n - off);
+    return end ? (long)(end - (rec + off)) : -1;
+}
+
+bool pp_get(const PuzzlePack *pk, size_t index, PackPuzzle *out) {
+    if (index >= pk->count) return false;
+    uint64_t start = pk->table[index], end = pk->table[index + 1];
+    uint64_t limit = (uint64_t)((const unsigned char*)pk->table - pk->base);
+    if (start % PACK_ALIGN || start < sizeof(PackHeader) || end <= start || end > limit) return false;
+    const char *rec = (const char*)pk->base + start;
+    size_t n = (size_t)(end - start);
+
+    PackRecord r;
+    if (n < sizeof r) return false;
+    memcpy(&r, rec, sizeof r);
+    if (r.rows == 0 || r.cols == 0 || r.rows > UINT16_MAX || r.cols > UINT16_MAX) return false;
+    size_t room = n - sizeof r;
+    if (r.nwords > room / sizeof(PackWordRec)) return false;
+    room -= r.nwords * sizeof(PackWordRec);
+    if ((size_t)r.rows * r.cols > room) return false;
+    if (str_in(rec, n, r.title) < 0) return false;
+
+    /* contents: the grid is blocks and capital letters, and every answer
+       spells out the cells it covers, so the loaded puzzle agrees with
+       itself and no control bytes reach a terminal */
+    const char *grid = rec + sizeof r + r.nwords * sizeof(PackWordRec);
+    for (size_t i = 0; i < (size_t)r.rows * r.cols; ++i)
+        if (grid[i] != '.' && (grid[i] < 'A' || grid[i] > 'Z')) return false;
+
+    const PackWordRec *words = (const PackWordRec*)(rec + sizeof r);
+    for (uint32_t k = 0; k < r.nwords; ++k) {
+        const PackWordRec *w = &words[k];
+        if (w->dir > DIR_DOWN || w->len == 0 || w->len >= MAX_WORD_LEN) return false;
+        if (w->row >= r.rows || w->col >= r.cols) return false;
+        if (w->dir == DIR_ACROSS ? w->len > r.cols - w->col : w->len > r.rows - w->row) return false;
+        if (str_in(rec, n, w->text) != (long)w->len || str_in(rec, n, w->clue) < 0) return false;
+        const char *text = rec + w->text;
+        size_t step = w->dir == DIR_ACROSS ? 1 : r.cols;
+        const char *cell = grid + (size_t)w->row * r.cols + w->col;
+        for (size_t i = 0; i < w->len; ++i, cell += step)
+            if (*cell == '.' || text[i] != *cell) return false;
+    }
+
+    out->title = rec + r.title;
+    out->rows = r.rows;
+    out->cols = r.cols;
+    out->word_count = r.nwords;
+    out->words = words;
+    out->grid = grid;
+    out->rec = rec;
+    return true;
+}
+
+void pp_word(const PackPuzzle *pz, size_t k, PackWord *out) {
+    const PackWordRec *w = &pz->words[k];
+    out->text = pz->rec + w->text;
+    out->clue = pz->rec + w->clue;
+    out->row = w->row;
+    out->col = w->col;
+    out->len = w->len;
+    out->dir = (Direction)w->dir;
+}
+
+Crossword *pp_load_crossword(const PackPuzzle *pz) {
+    Crossword *cw = create_crossword(pz->rows, pz->cols);
+    if (!cw) return NULL;
+    memcpy(cw->cells, pz->grid, pz->rows * pz->cols);
+    for (size_t k = 0; k < pz->word_count; ++k) {
+        PackWord w;
+        pp_word(pz, k, &w);
+        if (!add_placed_word(cw, w.text, w.row, w.col, w.dir, w.clue)) {
+            destroy_crossword(cw);
+            return NULL;
+        }
+    }
+    return cw;
+}
+
+/* ---------------- Writing ---------------- */
+
+bool pp_writer_open(PackWriter *w, const char *path) {
+    memset(w, 0, sizeof *w);
+    w->f = fopen(path, "wb");
+    if (!w->f) return false;
+    PackHeader h = { 0 };           /* filled in by pp_writer_close */
+    if (fwrite(&h, sizeof h, 1, w->f) != 1) w->failed = true;
+    w->pos = sizeof h;
+    return true;
+}
+
+static bool push_offset(PackWriter *w, uint64_t off) {
+    if (w->count == w->cap) {
+        size_t cap = w->cap ? w->cap * 2 : 256;
+        uint64_t *t = (uint64_t*)realloc(w->table, cap * sizeof(uint64_t));
+        if (!t) return false;
+        w->table = t;
+        w->cap = cap;
+    }
+    w->table[w->count++] = off;
+    return true;
+}
+
+bool pp_writer_add(PackWriter *w, const char *title, const Crossword *cw) {
+    if (!w->f || w->failed) return false;
+    if (cw->rows > UINT16_MAX || cw->cols > UINT16_MAX || cw->word_count > UINT32_MAX / 2) return false;
+
+    size_t head = sizeof(PackRecord) + cw->word_count * sizeof(PackWordRec);
+    size_t ncells = cw->rows * cw->cols;
+    size_t size = head + ncells + strlen(title) + 1;
+    for (size_t i = 0; i < cw->word_count; ++i)
+        size += cw->word_len[i] + 1u + strlen(cw_word_clue(cw, i)) + 1;
+    size_t padded = (size + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+    if (padded > UINT32_MAX) return false;
+
+    char *rec = (char*)calloc(padded, 1);
+    if (!rec) return false;
+    size_t at = head + ncells;
+    PackRecord r = { (uint32_t)cw->rows, (uint32_t)cw->cols, (uint32_t)cw->word_count, (uint32_t)at };
+    memcpy(rec, &r, sizeof r);
+    memcpy(rec + head, cw->cells, ncells);
+    size_t len = strlen(title) + 1;
+    memcpy(rec + at, title, len);
+    at += len;
+    for (size_t i = 0; i < cw->word_count; ++i) {
+        PackWordRec pw = { 0 };
+        pw.row = (uint16_t)cw->word_row[i];
+        pw.col = (uint16_t)cw->word_col[i];
+        pw.dir = cw->word_dir[i];
+        pw.len = cw->word_len[i];
+        pw.text = (uint32_t)at;
+        memcpy(rec + at, cw_word_text(cw, i), pw.len + 1u);
+        at += pw.len + 1u;
+        pw.clue = (uint32_t)at;
+        len = strlen(cw_word_clue(cw, i)) + 1;
+        memcpy(rec + at, cw_word_clue(cw, i), len);
+        at += len;
+        memcpy(rec + sizeof r + i * sizeof pw, &pw, sizeof pw);
+    }
+
+    bool ok = push_offset(w, w->pos) && fwrite(rec, 1, padded, w->f) == padded;
+    free(rec);
+    if (!ok) { w->failed = true; return false; }
+    w->pos += padded;
+    return true;
+}
+
+bool pp_writer_close(PackWriter *w) {
+    if (!w->f) return false;
+    bool ok = !w->failed && w->count < UINT32_MAX;
+    PackHeader h = { PACK_MAGIC, PACK_VERSION, (uint32_t)w->count, 0, w->pos };
+    if (ok) ok = push_offset(w, w->pos);
+    if (ok) ok = fwrite(w->table, sizeof(uint64_t), w->count, w->f) == w->count;
+    if (ok) ok = fseek(w->f, 0, SEEK_SET) == 0 && fwrite(&h, sizeof h, 1, w->f) == 1;
+    if (fclose(w->f) != 0) ok = false;
+    free(w->table);
+    memset(w, 0, sizeof *w);
+    return ok;
+}
@@ -0,0 +1,93 @@
+#ifndef PUZZLEPACK_H
+#define PUZZLEPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "crossword.h"
+
+/* Puzzle pack: a bank of finished puzzles in one file, read on demand.
+
+   File layout (native byte order, like the DAWG image):
+     PackHeader       magic, version, puzzle count, table offset
+     records          one per puzzle, each starting 8-byte aligned
+     offset table     count+1 uint64 file offsets; puzzle i occupies
+                      [table[i], table[i+1])
+
+   A record is a PackRecord, nwords PackWordRec entries, the rows*cols
+   solution grid ('.' = block), then the NUL-terminated title, answers and
+   clues (string offsets are from the record start).
+
+   pp_open maps the file and checks only the header and offset table; a
+   record is checked when pp_get reads it: its bounds, and that the grid
+   holds only '.' and 'A'-'Z' and agrees with every answer. Titles, answers and
+   clues are returned as pointers into the mapping, valid until pp_close. */
+
+#define PACK_MAGIC   0x4B505743u   /* "CWPK" little-endian */
+#define PACK_VERSION 1u
+
+typedef struct {
+    uint32_t magic, version, count, reserved;
+    uint64_t table;             /* file offset of the offset table */
+} PackHeader;
+
+typedef struct {
+    uint32_t rows, cols, nwords, title;
+} PackRecord;
+
+typedef struct {
+    uint16_t row, col;
+    uint8_t  dir, len, reserved[2];
+    uint32_t text, clue;
+} PackWordRec;
+
+typedef struct {
+    const unsigned char *base;  /* mapping or heap block holding the file */
+    size_t   len;
+    bool     mapped;
+    size_t   count;
+    const uint64_t *table;
+} PuzzlePack;
+
+/* One puzzle, viewed in place */
+typedef struct {
+    const char *title;
+    size_t rows, cols, word_count;
+    const char *grid;           /* rows*cols letters, not NUL-terminated */
+    const PackWordRec *words;
+    const char *rec;            /* record start, base of string offsets */
+} PackPuzzle;
+
+typedef struct {
+    const char *text;
+    const char *clue;
+    size_t row, col, len;
+    Direction dir;
+} PackWord;
+
+/* Reading */
+bool pp_open(const char *path, PuzzlePack *pk);
+void pp_close(PuzzlePack *pk);
+size_t pp_count(const PuzzlePack *pk);
+/* false if index is out of range or the record is malformed or inconsistent */
+bool pp_get(const PuzzlePack *pk, size_t index, PackPuzzle *out);
+void pp_word(const PackPuzzle *pz, size_t k, PackWord *out);
+/* Crossword for the puzzle: copies the grid and records the words
+   without re-running placement. NULL on allocation failure. */
+Crossword *pp_load_crossword(const PackPuzzle *pz);
+
+/* Writing: records are streamed out, the table and header go in on close */
+typedef struct {
+    FILE     *f;
+    uint64_t *table;
+    size_t    count, cap;
+    uint64_t  pos;
+    bool      failed;
+} PackWriter;
+
+bool pp_writer_open(PackWriter *w, const char *path);
+bool pp_writer_add(PackWriter *w, const char *title, const Crossword *cw);
+bool pp_writer_close(PackWriter *w);
+
+#endif
@@ -0,0 +1,246 @@
+#include "render.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+void fb_init(FrameBuf *fb) {
+    fb->data = NULL;
+    fb->len = fb->cap = 0;
+    fb->failed = false;
+}
+
+void fb_free(FrameBuf *fb) {
+    free(fb->data);
+    fb_init(fb);
+}
+
+void fb_reset(FrameBuf *fb) {
+    fb->len = 0;
+    fb->failed = false;
+}
+
+static bool fb_reserve(FrameBuf *fb, size_t extra) {
+    if (fb->failed) return false;
+    if (extra > SIZE_MAX - fb->len - 1) { fb->failed = true; return false; }
+    size_t need = fb->len + extra + 1;      /* keep room for a terminator */
+    if (need <= fb->cap) return true;
+    size_t cap = fb->cap ? fb->cap : 256;
+    while (cap < need) cap = cap > SIZE_MAX / 2 ? need : cap * 2;
+    char *p = (char*)realloc(fb->data, cap);
+    if (!p) { fb->failed = true; return false; }
+    fb->data = p;
+    fb->cap = cap;
+    return true;
+}
+
+void fb_append(FrameBuf *fb, const char *s, size_t n) {
+    if (!fb_reserve(fb, n)) return;
+    memcpy(fb->data + fb->len, s, n);
+    fb->len += n;
+    fb->data[fb->len] = '\0';
+}
+
+void fb_puts(FrameBuf *fb, const char *s) {
+    fb_append(fb, s, strlen(s));
+}
+
+void fb_putc(FrameBuf *fb, char c) {
+    fb_append(fb, &c, 1);
+}
+
+void fb_printf(FrameBuf *fb, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    char small[256];
+    int n = vsnprintf(small, sizeof small, fmt, ap);
+    va_end(ap);
+    if (n < 0) { fb->failed = true; return; }
+    if ((size_t)n < sizeof small) { fb_append(fb, small, (size_t)n); return; }
+    if (!fb_reserve(fb, (size_t)n)) return;
+    va_start(ap, fmt);
+    vsnprintf(fb->data + fb->len, (size_t)n + 1, fmt, ap);
+    va_end(ap);
+    fb->len += (size_t)n;
+}
+
+bool fb_flush(FrameBuf *fb, FILE *out) {
+    bool ok = !fb->failed;
+    if (fb->len && fwrite(fb->data, 1, fb->len, out) != fb->len) ok = false;
+    fflush(out);
+    fb_reset(fb);
+    return ok;
+}
+
+/* one horizontal border line: "    " + cols * left + right + "\n" */
+static void render_border(FrameBuf *fb, size_t cols, const char *left, const char *right) {
+    size_t lw = strlen(left);
+    fb_append(fb, "    ", 4);
+    for (size_t c = 0; c < cols; ++c) fb_append(fb, left, lw);
+    fb_puts(fb, right);
+    fb_putc(fb, '\n');
+}
+
+/* a letter the player entered in a cell not yet revealed, in lowercase
+   so it reads as pencilled in; ' ' if none */
+static char entered_glyph(const Crossword *cw, const Session *s, DisplayMode mode, size_t r, size_t c) {
+    char e = mode == DISPLAY_SOLVED ? session_cell_entered(cw, s, r, c) : '\0';
+    return e ? (char)(e - 'A' + 'a') : ' ';
+}
+
+void render_crossword(const Crossword *cw, const Session *s, DisplayMode mode, FrameBuf *fb) {
+    fb_putc(fb, '\n');
+    for (size_t r = 0; r < cw->rows; ++r) {
+        render_border(fb, cw->cols, "┌───", "┐");
+        fb_append(fb, "    ", 4);
+        for (size_t c = 0; c < cw->cols; ++c) {
+            char ch = CW_CELL(cw, r, c);
+            if (ch == '.') { fb_puts(fb, "│███"); continue; }
+            bool visible = mode == DISPLAY_ALL ||
+                           (mode == DISPLAY_SOLVED && session_cell_revealed(cw, s, r, c));
+            char cell[] = "│ ? ";
+            cell[sizeof cell - 3] = visible ? ch : entered_glyph(cw, s, mode, r, c);
+            fb_append(fb, cell, sizeof cell - 1);
+        }
+        fb_puts(fb, "│\n");
+    }
+    render_border(fb, cw->cols, "└───", "┘");
+}
+
+void render_progress(const Crossword *cw, const Session *s, FrameBuf *fb) {
+    size_t solved = s && s->word_count == cw->word_count ? s->solved_count : 0;
+    double pct = cw->word_count ? (100.0 * solved / (double)cw->word_count) : 100.0;
+    fb_printf(fb, "Progress: %zu/%zu solved (%.1f%%)\n", solved, cw->word_count, pct);
+}
+
+void render_clues(const Crossword *cw, const Session *s, FrameBuf *fb) {
+    static const char *const heading[2] = { "\nAcross:\n", "Down:\n" };
+    for (int d = DIR_ACROSS; d <= DIR_DOWN; ++d) {
+        fb_puts(fb, heading[d]);
+        for (size_t i = 0; i < cw->word_count; ++i) {
+            if (cw->word_dir[i] != d) continue;
+            fb_printf(fb, "  %2zu) (%zu,%zu) %s%s\n", i, (size_t)cw->word_row[i], (size_t)cw->word_col[i],
+                      cw_word_clue(cw, i), session_word_solved(s, i) ? "  [solved]" : "");
+        }
+    }
+}
+
+void render_solution(const Crossword *cw, FrameBuf *fb) {
+    fb_puts(fb, "\nSOLUTION:\n");
+    render_crossword(cw, NULL, DISPLAY_ALL, fb);
+    for (size_t i = 0; i < cw->word_count; ++i) {
+        fb_printf(fb, "  %2zu) %s (%s) at (%zu,%zu)\n", i, cw_word_text(cw, i),
+                  cw->word_dir[i] == DIR_ACROSS ? "ACROSS" : "DOWN",
+                  (size_t)cw->word_row[i], (size_t)cw->word_col[i]);
+    }
+}
+
+/* ---------------- Incremental ANSI view ---------------- */
+
+/* Screen layout of render_crossword (1-based): a blank line, then a border
+   and a content line per row. Cell (r,c) holds its glyph at column 7+4c. */
+#define ANSI_CELL_LINE(r) (3 + 2 * (r))
+#define ANSI_CELL_COL(c)  (7 + 4 * (c))
+#define ANSI_PROGRESS_LINE(rows) (3 + 2 * (rows))
+
+void ansi_view_init(AnsiView *v) {
+    v->rows = v->cols = 0;
+    v->shown = NULL;
+    v->progress[0] = '\0';
+    v->drawn = false;
+}
+
+void ansi_view_free(AnsiView *v) {
+    free(v->shown);
+    ansi_view_init(v);
+}
+
+void ansi_view_invalidate(AnsiView *v) {
+    v->drawn = false;
+}
+
+static char cell_glyph(const Crossword *cw, const Session *s, DisplayMode mode, size_t r, size_t c) {
+    char ch = CW_CELL(cw, r, c);
+    if (ch == '.') return '.';
+    bool visible = mode == DISPLAY_ALL ||
+                   (mode == DISPLAY_SOLVED && session_cell_revealed(cw, s, r, c));
+    return visible ? ch : entered_glyph(cw, s, mode, r, c);
+}
+
+/* progress line without its trailing newline */
+static void progress_text(const Crossword *cw, const Session *s, char *out, size_t n) {
+    FrameBuf tmp;
+    fb_init(&tmp);
+    render_progress(cw, s, &tmp);
+    size_t len = tmp.failed ? 0 : tmp.len;
+    if (len && tmp.data[len - 1] == '\n') --len;
+    if (len >= n) len = n - 1;
+    if (len) memcpy(out, tmp.data, len);
+    out[len] = '\0';
+    fb_free(&tmp);
+}
+
+static void ansi_full_redraw(AnsiView *v, const Crossword *cw, const Session *s,
+                             DisplayMode mode, FrameBuf *fb)
+{
+    size_t ncells = cw->rows * cw->cols;
+    if (!v->shown || v->rows * v->cols != ncells) {
+        char *p = (char*)realloc(v->shown, ncells ? ncells : 1);
+        if (!p) { fb->failed = true; return; }
+        v->shown = p;
+    }
+    v->rows = cw->rows;
+    v->cols = cw->cols;
+    for (size_t r = 0; r < cw->rows; ++r)
+        for (size_t c = 0; c < cw->cols; ++c)
+            v->shown[r * cw->cols + c] = cell_glyph(cw, s, mode, r, c);
+    progress_text(cw, s, v->progress, sizeof v->progress);
+
+    fb_puts(fb, "\033[r\033[H\033[2J");        /* reset scroll region, clear */
+    render_crossword(cw, s, mode, fb);
+    fb_puts(fb, v->progress);
+    fb_putc(fb, '\n');
+    /* pin the board: only lines below it scroll from now on */
+    size_t top = ANSI_PROGRESS_LINE(cw->rows) + 1;
+    fb_printf(fb, "\033[%zur\033[%zu;1H", top, top);
+    v->drawn = true;
+}
+
+void ansi_render(AnsiView *v, const Crossword *cw, const Session *s, DisplayMode mode, FrameBuf *fb) {
+    if (!v->drawn || v->rows != cw->rows || v->cols != cw->cols) {
+        ansi_full_redraw(v, cw, s, mode, fb);
+        return;
+    }
+    size_t start = fb->len;
+    fb_puts(fb, "\0337");                         /* save cursor */
+    size_t mark = fb->len;
+    for (size_t r = 0; r < cw->rows; ++r) {
+        for (size_t c = 0; c < cw->cols; ++c) {
+            char g = cell_glyph(cw, s, mode, r, c);
+            char *old = &v->shown[r * cw->cols + c];
+            if (g == *old) continue;
+            if (g == '.' || *old == '.') {
+                /* drop the save and the updates so far: the redraw covers them */
+                fb->len = start;
+                if (fb->data) fb->data[start] = '\0';
+                ansi_full_redraw(v, cw, s, mode, fb);
+                return;
+            }
+            fb_printf(fb, "\033[%zu;%zuH%c", (size_t)ANSI_CELL_LINE(r), (size_t)ANSI_CELL_COL(c), g);
+            *old = g;
+        }
+    }
+    char prog[sizeof v->progress];
+    progress_text(cw, s, prog, sizeof prog);
+    if (strcmp(prog, v->progress) != 0) {
+        fb_printf(fb, "\033[%zu;1H\033[2K%s", (size_t)ANSI_PROGRESS_LINE(cw->rows), prog);
+        memcpy(v->progress, prog, sizeof prog);
+    }
+    if (fb->len == mark) { fb->len = start; if (fb->data) fb->data[start] = '\0'; return; }
+    fb_puts(fb, "\0338");                         /* restore cursor */
+}
+
+void ansi_release(AnsiView *v, FrameBuf *fb) {
+    if (v->drawn) fb_puts(fb, "\0337\033[r\0338");   /* keep the cursor where it is */
+    v->drawn = false;
+}
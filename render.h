@@ -0,0 +1,58 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "crossword.h"
+
+/* Growable output buffer: a whole frame is composed here and written once */
+typedef struct {
+    char  *data;
+    size_t len, cap;
+    bool   failed;      /* sticky: set when an append could not allocate */
+} FrameBuf;
+
+/* buffer management */
+void fb_init(FrameBuf *fb);
+void fb_free(FrameBuf *fb);
+void fb_reset(FrameBuf *fb);
+
+/* appending */
+void fb_append(FrameBuf *fb, const char *s, size_t n);
+void fb_puts(FrameBuf *fb, const char *s);
+void fb_putc(FrameBuf *fb, char c);
+void fb_printf(FrameBuf *fb, const char *fmt, ...);
+
+/* write the buffered frame with a single fwrite, then reset it */
+bool fb_flush(FrameBuf *fb, FILE *out);
+
+/* frame composition (append to fb, no I/O); s may be NULL */
+void render_crossword(const Crossword *cw, const Session *s, DisplayMode mode, FrameBuf *fb);
+void render_progress(const Crossword *cw, const Session *s, FrameBuf *fb);
+void render_clues(const Crossword *cw, const Session *s, FrameBuf *fb);
+void render_solution(const Crossword *cw, FrameBuf *fb);
+
+/* ================= INCREMENTAL ANSI VIEW ================= */
+
+/* Remembers the last frame drawn to an ANSI terminal. The grid and the
+   progress line are pinned at the top of the screen (everything else
+   scrolls below them), so later renders only move the cursor to the
+   cells whose glyph changed and rewrite those. */
+typedef struct {
+    size_t rows, cols;      /* size of the last full frame */
+    char  *shown;           /* rows*cols glyphs as currently on screen */
+    char   progress[96];    /* progress text as currently on screen */
+    bool   drawn;           /* false -> next render is a full redraw */
+} AnsiView;
+
+void ansi_view_init(AnsiView *v);
+void ansi_view_free(AnsiView *v);
+void ansi_view_invalidate(AnsiView *v);
+
+/* append a full frame or just the escape-coded differences to fb */
+void ansi_render(AnsiView *v, const Crossword *cw, const Session *s, DisplayMode mode, FrameBuf *fb);
+/* append the sequence that hands the whole screen back to normal scrolling */
+void ansi_release(AnsiView *v, FrameBuf *fb);
+
+#endif
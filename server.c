@@ -0,0 +1,384 @@
+// server.c - multi-player game server: line commands over a Unix or TCP
+// socket, clients multiplexed on epoll event loops
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     /* accept4, EPOLLEXCLUSIVE */
+#endif
+#include "server.h"
+
+#include <stdio.h>
+
+#ifndef __linux__
+
+int server_run(const char *addr, unsigned loops) {
+    (void)addr;
+    (void)loops;
+    fputs("Server mode needs Linux (epoll).\n", stderr);
+    return 1;
+}
+
+#else
+
+#include "game.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define SRV_LINE_MAX   512      /* longest command line, as in the terminal loop */
+#define SRV_MAX_EVENTS 256
+
+/* One client. Lines are collected in `in` and run through the Game as
+   they complete; replies pile up in `out` and are sent as the socket
+   accepts them. While a reply is still going out the connection is only
+   watched for EPOLLOUT, so a client that does not read stops being read. */
+typedef struct Conn {
+    int       fd;
+    Game      game;
+    char      in[SRV_LINE_MAX];
+    size_t    in_len;
+    bool      discarding;       // dropping the rest of an over-long line
+    bool      closing;          // quit received: close once out is sent
+    FrameBuf  out;
+    size_t    out_off;          // bytes of out already sent
+    uint32_t  events;           // epoll events currently registered
+    struct Conn *prev, *next;
+} Conn;
+
+typedef struct {
+    int       epfd;
+    int       listen_fd;        // shared by every loop
+    int       spare_fd;         // given up to shed a client when out of fds
+    Conn     *conns;            // open connections, for shutdown
+    uint64_t  seed;
+    uint64_t  accepted;
+    pthread_t tid;
+} Loop;
+
+/* set from a signal handler, read by every loop thread */
+static atomic_bool stop_requested = false;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = true;
+}
+
+/* one leaderboard, many loops */
+static pthread_mutex_t lb_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void lb_lock(void)   { pthread_mutex_lock(&lb_mutex); }
+static void lb_unlock(void) { pthread_mutex_unlock(&lb_mutex); }
+
+/* ---------------- Connections ---------------- */
+
+static void close_conn(Loop *l, Conn *c) {
+    epoll_ctl(l->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    if (c->prev) c->prev->next = c->next;
+    else l->conns = c->next;
+    if (c->next) c->next->prev = c->prev;
+    game_free(&c->game);
+    fb_free(&c->out);
+    free(c);
+}
+
+static bool watch(Loop *l, Conn *c, uint32_t events) {
+    if (c->events == events) return true;
+    struct epoll_event ev = { .events = events, .data.ptr = c };
+    if (epoll_ctl(l->epfd, EPOLL_CTL_MOD, c->fd, &ev) != 0) return false;
+    c->events = events;
+    return true;
+}
+
+/* send what the socket takes; false once the connection is closed */
+static bool flush_out(Loop *l, Conn *c) {
+    if (c->out.failed) { close_conn(l, c); return false; }
+    while (c->out_off < c->out.len) {
+        ssize_t n = send(c->fd, c->out.data + c->out_off, c->out.len - c->out_off, MSG_NOSIGNAL);
+        if (n > 0) { c->out_off += (size_t)n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!watch(l, c, EPOLLOUT)) { close_conn(l, c); return false; }
+            return true;
+        }
+        close_conn(l, c);
+        return false;
+    }
+    fb_reset(&c->out);
+    c->out_off = 0;
+    if (c->closing || !watch(l, c, EPOLLIN)) { close_conn(l, c); return false; }
+    return true;
+}
+
+/* run every complete line in the input buffer */
+static void run_lines(Conn *c) {
+    size_t start = 0;
+    char *nl;
+    while (!c->closing && (nl = (char*)memchr(c->in + start, '\n', c->in_len - start)) != NULL) {
+        char *line = c->in + start;
+        start = (size_t)(nl - c->in) + 1;
+        *nl = '\0';
+        if (nl > line && nl[-1] == '\r') nl[-1] = '\0';
+        if (c->discarding) { c->discarding = false; continue; }
+        if (!game_command(&c->game, line, &c->out)) {
+            game_finish(&c->game, &c->out);
+            c->closing = true;
+            break;
+        }
+        game_prompt(&c->game, &c->out);
+    }
+    if (c->closing) { c->in_len = 0; return; }
+    memmove(c->in, c->in + start, c->in_len - start);
+    c->in_len -= start;
+    if (c->in_len == sizeof c->in) {
+        /* no newline in a full buffer: answer once, skip to the next line */
+        c->in_len = 0;
+        if (!c->discarding) {
+            fb_puts(&c->out, "Line too long.\n");
+            game_prompt(&c->game, &c->out);
+        }
+        c->discarding = true;
+    }
+}
+
+static void on_readable(Loop *l, Conn *c) {
+    ssize_t n = recv(c->fd, c->in + c->in_len, sizeof c->in - c->in_len, 0);
+    if (n == 0) {
+        /* client is done sending; finish any reply already due, then go */
+        c->closing = true;
+        flush_out(l, c);
+        return;
+    }
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) close_conn(l, c);
+        return;
+    }
+    c->in_len += (size_t)n;
+    run_lines(c);
+    flush_out(l, c);
+}
+
+static void accept_clients(Loop *l) {
+    for (;;) {
+        int fd = accept4(l->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if ((errno == EMFILE || errno == ENFILE) && l->spare_fd >= 0) {
+                /* out of descriptors: take the client and hang up at once,
+                   rather than leave it queued and the listener always ready */
+                close(l->spare_fd);
+                fd = accept(l->listen_fd, NULL, NULL);
+                if (fd >= 0) close(fd);
+                l->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                continue;
+            }
+            return;     /* EAGAIN: queue drained (or another loop took it) */
+        }
+        Conn *c = (Conn*)calloc(1, sizeof *c);
+        ++l->accepted;
+        unsigned long seed = (unsigned long)(l->seed + l->accepted * 0x9E3779B97F4A7C15ull);
+        if (!c || !game_init(&c->game, false, seed)) {
+            free(c);
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+        fb_init(&c->out);
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        if (epoll_ctl(l->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            game_free(&c->game);
+            free(c);
+            close(fd);
+            continue;
+        }
+        c->next = l->conns;
+        if (l->conns) l->conns->prev = c;
+        l->conns = c;
+
+        game_present(&c->game, &c->out);
+        game_prompt(&c->game, &c->out);
+        flush_out(l, c);
+    }
+}
+
+/* ---------------- Event loop ---------------- */
+
+static void *loop_main(void *arg) {
+    Loop *l = (Loop*)arg;
+    struct epoll_event ev[SRV_MAX_EVENTS];
+    while (!stop_requested) {
+        int n = epoll_wait(l->epfd, ev, SRV_MAX_EVENTS, 500);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            Conn *c = (Conn*)ev[i].data.ptr;
+            if (!c) { accept_clients(l); continue; }
+            if (c->events & EPOLLIN) {
+                /* readable, or hung up: recv tells which */
+                if (ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) on_readable(l, c);
+            } else if (ev[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+                flush_out(l, c);
+            }
+        }
+    }
+    while (l->conns) close_conn(l, l->conns);
+    return NULL;
+}
+
+/* ---------------- Listening socket ---------------- */
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sun_family = AF_UNIX;
+    if (!*path || strlen(path) >= sizeof sa.sun_path) { errno = ENAMETOOLONG; return -1; }
+    strcpy(sa.sun_path, path);
+
+    /* a socket left behind by an earlier run is replaced; any other file is not */
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, (struct sockaddr*)&sa, sizeof sa) != 0 || listen(fd, SOMAXCONN) != 0) {
+        int e = errno;
+        close(fd);
+        errno = e;
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(const char *addr) {
+    char host[256];
+    const char *port = strrchr(addr, ':');
+    if (port) {
+        size_t n = (size_t)(port - addr);
+        if (n && addr[0] == '[' && addr[n - 1] == ']') { ++addr; n -= 2; }
+        if (n >= sizeof host) { errno = EINVAL; return -1; }
+        memcpy(host, addr, n);
+        host[n] = '\0';
+        ++port;
+    } else {
+        host[0] = '\0';
+        port = addr;
+    }
+    if (!host[0]) strcpy(host, "127.0.0.1");
+
+    struct addrinfo hints, *res, *ai;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int rc = getaddrinfo(host, port, &hints, &res);
+    if (rc != 0) {
+        fprintf(stderr, "%s: %s\n", addr, gai_strerror(rc));
+        errno = EINVAL;
+        return -1;
+    }
+    int fd = -1;
+    for (ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) break;
+        int e = errno;
+        close(fd);
+        errno = e;
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+/* every client costs a descriptor: use all the hard limit allows */
+static void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+/* ---------------- Server ---------------- */
+
+int server_run(const char *addr, unsigned loops) {
+    bool is_unix = strncmp(addr, "unix:", 5) == 0;
+    int lfd = is_unix ? listen_unix(addr + 5) : listen_tcp(addr);
+    if (lfd < 0) {
+        fprintf(stderr, "Could not listen on %s: %s\n", addr, strerror(errno));
+        return 1;
+    }
+    raise_fd_limit();
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (loops == 0) loops = 1;
+    Loop *ls = (Loop*)calloc(loops, sizeof(Loop));
+    if (!ls) { close(lfd); return 1; }
+    if (loops > 1) game_set_lb_lock(lb_lock, lb_unlock);
+
+    /* every loop watches the one listener; EPOLLEXCLUSIVE wakes just one
+       of them per incoming connection instead of the whole herd */
+    unsigned ready = 0;
+    for (; ready < loops; ++ready) {
+        Loop *l = &ls[ready];
+        l->listen_fd = lfd;
+        l->seed = (uint64_t)time(NULL) ^ ((uint64_t)(ready + 1) << 40);
+        l->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (l->epfd < 0) break;
+        struct epoll_event ev = { .events = EPOLLIN | (loops > 1 ? EPOLLEXCLUSIVE : 0), .data.ptr = NULL };
+        if (epoll_ctl(l->epfd, EPOLL_CTL_ADD, lfd, &ev) != 0) { close(l->epfd); break; }
+        l->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+    unsigned started = ready ? 1 : 0;
+    while (started < ready && pthread_create(&ls[started].tid, NULL, loop_main, &ls[started]) == 0)
+        ++started;
+
+    int status = 0;
+    if (started == 0) {
+        perror("epoll");
+        status = 1;
+    } else {
+        printf("Serving on %s with %u event loop%s. Ctrl-C to stop.\n", addr, started, started == 1 ? "" : "s");
+        fflush(stdout);
+        loop_main(&ls[0]);
+        stop_requested = true;
+        for (unsigned i = 1; i < started; ++i) pthread_join(ls[i].tid, NULL);
+    }
+
+    for (unsigned i = 0; i < ready; ++i) {
+        /* loops that never got a thread still own their epoll fd */
+        close(ls[i].epfd);
+        if (ls[i].spare_fd >= 0) close(ls[i].spare_fd);
+    }
+    free(ls);
+    close(lfd);
+    if (is_unix) unlink(addr + 5);
+    game_set_lb_lock(NULL, NULL);
+    return status;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,15 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/* Serve the game to many clients at once. addr is "unix:/path/to/socket"
+   or "[host:]port" for TCP (host defaults to 127.0.0.1). Every connection
+   gets its own Game (puzzle, session and timer) and speaks the same line
+   commands as the terminal; after each reply the server sends a "> "
+   prompt. Clients are multiplexed on `loops` epoll event loops, one
+   thread each, sharing a single listening socket.
+
+   Runs until SIGINT/SIGTERM; returns the process exit status. Needs
+   Linux (epoll); elsewhere it reports that and returns 1. */
+int server_run(const char *addr, unsigned loops);
+
+#endif
@@ -0,0 +1,128 @@
+// test_dawg.c - dawg_build/dawg_save/dawg_open against the word list they came from
+#include "../dawg.h"
+#include "../crossword.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); ++failures; } \
+} while (0)
+
+static const char *const WORDS[] = {
+    "CAT", "CATS", "CAR", "CARD", "CARDS", "CART", "DOG", "DOGS", "DOT",
+    "CODE", "CODA", "CEDE", "CUDDLE", "A", "AT", "TAB", "TABS", "STAB",
+    "CAT",              /* duplicate */
+    "cat", "C4T", "", "TOOLONGTOOLONGTOOLONGTOOLONGTOOLONG",   /* skipped: not 1..31 of A-Z */
+};
+#define NWORDS (sizeof WORDS / sizeof WORDS[0])
+
+/* the words dawg_build is documented to keep */
+static bool kept(const char *w) {
+    size_t n = strlen(w);
+    if (n == 0 || n >= MAX_WORD_LEN) return false;
+    for (size_t i = 0; i < n; ++i) if (w[i] < 'A' || w[i] > 'Z') return false;
+    return true;
+}
+
+static bool fits(const char *pattern, const char *w) {
+    if (strlen(pattern) != strlen(w)) return false;
+    for (; *w; ++w, ++pattern)
+        if (*pattern != '?' && *pattern != '.' && toupper((unsigned char)*pattern) != *w) return false;
+    return true;
+}
+
+typedef struct {
+    char seen[NWORDS * 2][MAX_WORD_LEN];
+    size_t n;
+} Collected;
+
+static void collect(void *ctx, const char *word) {
+    Collected *c = (Collected*)ctx;
+    if (c->n < NWORDS * 2) snprintf(c->seen[c->n], MAX_WORD_LEN, "%s", word);
+    ++c->n;
+}
+
+/* every stored word is found, near misses are not */
+static void check_contains(const Dawg *d) {
+    for (size_t i = 0; i < NWORDS; ++i)
+        if (kept(WORDS[i])) CHECK(dawg_contains(d, WORDS[i]));
+    CHECK(dawg_contains(d, "cat"));             /* queries ignore case */
+    CHECK(!dawg_contains(d, "CA"));             /* prefix only */
+    CHECK(!dawg_contains(d, "CARDSS"));
+    CHECK(!dawg_contains(d, "DOC"));
+    CHECK(!dawg_contains(d, "C4T"));
+    CHECK(!dawg_contains(d, ""));
+}
+
+/* dawg_match agrees with a scan of the input, in alphabetical order */
+static void check_match(const Dawg *d, const char *pattern) {
+    size_t expect = 0;
+    for (size_t i = 0; i < NWORDS; ++i) {
+        if (!kept(WORDS[i]) || !fits(pattern, WORDS[i])) continue;
+        bool dup = false;
+        for (size_t j = 0; j < i; ++j) dup |= strcmp(WORDS[i], WORDS[j]) == 0;
+        if (!dup) ++expect;
+    }
+    Collected c;
+    c.n = 0;
+    CHECK(dawg_match(d, pattern, collect, &c) == expect);
+    CHECK(c.n == expect);
+    for (size_t i = 0; i < c.n && i < NWORDS * 2; ++i) {
+        CHECK(fits(pattern, c.seen[i]));
+        CHECK(dawg_contains(d, c.seen[i]));
+        if (i) CHECK(strcmp(c.seen[i - 1], c.seen[i]) < 0);
+    }
+    CHECK(dawg_match(d, pattern, NULL, NULL) == expect);
+}
+
+static void check_all(const Dawg *d) {
+    size_t distinct = 0;
+    for (size_t i = 0; i < NWORDS; ++i) {
+        if (!kept(WORDS[i])) continue;
+        bool dup = false;
+        for (size_t j = 0; j < i; ++j) dup |= strcmp(WORDS[i], WORDS[j]) == 0;
+        if (!dup) ++distinct;
+    }
+    CHECK(d->nwords == distinct);
+    check_contains(d);
+    const char *patterns[] = { "C?D?", "CA??", "?A?", "...", "????S", "?", "X??", "CUDDLE", "c?t" };
+    for (size_t i = 0; i < sizeof patterns / sizeof patterns[0]; ++i) check_match(d, patterns[i]);
+}
+
+int main(void) {
+    Dawg built;
+    CHECK(dawg_build(WORDS, NWORDS, &built));
+    check_all(&built);
+
+    const char *path = "test_dawg.tmp";
+    CHECK(dawg_save(&built, path));
+    Dawg opened;
+    CHECK(dawg_open(path, &opened));
+    CHECK(opened.nedges == built.nedges && opened.root == built.root);
+    CHECK(memcmp(opened.edges, built.edges, built.nedges * sizeof(uint32_t)) == 0);
+    check_all(&opened);
+    dawg_close(&opened);
+
+    /* a truncated image is refused, not read past its end */
+    FILE *f = fopen(path, "wb");
+    CHECK(f && fwrite(built.base, 1, built.base_len - 4, f) == built.base_len - 4);
+    if (f) fclose(f);
+    CHECK(!dawg_open(path, &opened));
+    remove(path);
+    dawg_close(&built);
+
+    Dawg empty;
+    CHECK(dawg_build(NULL, 0, &empty));
+    CHECK(!dawg_contains(&empty, "CAT"));
+    CHECK(dawg_match(&empty, "???", NULL, NULL) == 0);
+    dawg_close(&empty);
+
+    if (failures) { fprintf(stderr, "%d check(s) failed\n", failures); return 1; }
+    puts("test_dawg: ok");
+    return 0;
+}
@@ -0,0 +1,146 @@
+// test_wordlist.c - wl_load_file line handling, chunk boundaries and counters
+#include "../wordlist.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); ++failures; } \
+} while (0)
+
+#define MAX_LEN 31
+#define CHUNK   (1u << 20)          /* WL_CHUNK in wordlist.c */
+
+static const char *path = "test_wordlist.tmp";
+
+static bool has_word(const WordList *wl, const char *w) {
+    for (size_t i = 0; i < wl->count; ++i) if (strcmp(wl_word(wl, i), w) == 0) return true;
+    return false;
+}
+
+static void write_file(const char *data, size_t len) {
+    FILE *f = fopen(path, "wb");
+    CHECK(f != NULL);
+    if (!f) return;
+    CHECK(fwrite(data, 1, len, f) == len);
+    fclose(f);
+}
+
+static void load(WordList *wl, WordListStats *st) {
+    wl_init(wl);
+    memset(st, 0, sizeof *st);
+    CHECK(wl_load_file(wl, path, MAX_LEN, st));
+}
+
+/* CRLF endings, case folding, too-long and non-ASCII lines, a last line
+   without a newline */
+static void test_lines(void) {
+    const char data[] =
+        "cat\r\n"
+        "Dog\n"
+        "\n"
+        "\r\n"
+        "CAT\n"
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZABCDE\n"         /* 31: longest accepted */
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZABCDEF\n"        /* 32: too long */
+        "caf\xc3\xa9\n"                             /* UTF-8 e-acute */
+        "abcdefghijklmnop\xe9qrs\n"                 /* high byte inside a 16-byte block */
+        "two words\n"
+        "lastline";
+    WordList wl;
+    WordListStats st;
+    write_file(data, sizeof data - 1);
+    load(&wl, &st);
+    CHECK(st.bytes == sizeof data - 1);
+    CHECK(st.lines == 9);                   /* blank and bare "\r" lines are not counted */
+    CHECK(st.accepted == 4);
+    CHECK(st.duplicates == 1);
+    CHECK(st.too_long == 1);
+    CHECK(st.invalid == 3);
+    CHECK(wl.count == 4);
+    CHECK(has_word(&wl, "CAT"));
+    CHECK(has_word(&wl, "DOG"));
+    CHECK(has_word(&wl, "ABCDEFGHIJKLMNOPQRSTUVWXYZABCDE"));
+    CHECK(has_word(&wl, "LASTLINE"));
+    CHECK(strcmp(wl_word(&wl, 0), "CAT") == 0);             /* input order */
+    wl_free(&wl);
+}
+
+/* a word split by the 1 MiB read boundary is joined, and its repeats in
+   the next chunk are counted as duplicates */
+static void test_chunk_boundary(void) {
+    size_t cap = CHUNK * 3;
+    char *data = (char*)malloc(cap);
+    CHECK(data != NULL);
+    if (!data) return;
+    size_t len = 0, filler = 0;
+    /* distinct filler words ("AAAAA\n", "AAAAB\n", ...) up to just before the boundary */
+    while (len + 6 <= CHUNK - 4) {
+        size_t v = filler++;
+        for (int k = 4; k >= 0; --k) { data[len + (size_t)k] = (char)('A' + v % 26); v /= 26; }
+        data[len + 5] = '\n';
+        len += 6;
+    }
+    while (len < CHUNK - 4) data[len++] = '\n';
+    memcpy(data + len, "BOUNDARY\r\n", 10);    /* starts 4 bytes before the boundary */
+    len += 10;
+    for (int rep = 0; rep < 3; ++rep) {
+        memcpy(data + len, "boundary\nAAAAA\n", 15);
+        len += 15;
+    }
+    WordList wl;
+    WordListStats st;
+    write_file(data, len);
+    load(&wl, &st);
+    CHECK(st.bytes == len);
+    CHECK(st.accepted == filler + 1);
+    CHECK(st.duplicates == 6);
+    CHECK(st.invalid == 0 && st.too_long == 0);
+    CHECK(wl.count == filler + 1);
+    CHECK(has_word(&wl, "BOUNDARY"));
+    CHECK(!has_word(&wl, "BOUN") && !has_word(&wl, "DARY"));
+    wl_free(&wl);
+    free(data);
+}
+
+/* a line longer than the whole read buffer is skipped as one too-long
+   line, and reading carries on after it */
+static void test_overlong_line(void) {
+    size_t big = CHUNK * 2 + 123;
+    size_t len = 0;
+    char *data = (char*)malloc(big + 64);
+    CHECK(data != NULL);
+    if (!data) return;
+    memcpy(data, "FIRST\n", 6);
+    len = 6;
+    memset(data + len, 'X', big);
+    len += big;
+    memcpy(data + len, "\nSECOND\nFIRST\n", 14);
+    len += 14;
+    WordList wl;
+    WordListStats st;
+    write_file(data, len);
+    load(&wl, &st);
+    CHECK(st.bytes == len);
+    CHECK(st.lines == 4);
+    CHECK(st.too_long == 1);
+    CHECK(st.accepted == 2);
+    CHECK(st.duplicates == 1);
+    CHECK(wl.count == 2);
+    CHECK(has_word(&wl, "FIRST") && has_word(&wl, "SECOND"));
+    wl_free(&wl);
+    free(data);
+}
+
+int main(void) {
+    test_lines();
+    test_chunk_boundary();
+    test_overlong_line();
+    remove(path);
+    if (failures) { fprintf(stderr, "%d check(s) failed\n", failures); return 1; }
+    puts("test_wordlist: ok");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "wordindex.h"
+#include <stdlib.h>
+#include <string.h>
+
+static inline unsigned popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (unsigned)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+static size_t word_len_if_valid(const char *w) {
+    size_t n = 0;
+    for (; w[n]; ++n) {
+        if (n >= MAX_WORD_LEN - 1 || w[n] < 'A' || w[n] > 'Z') return 0;
+    }
+    return n;
+}
+
+bool wi_build(WordIndex *wi, const char *const *words, size_t count, size_t *bit_of) {
+    memset(wi, 0, sizeof *wi);
+    for (size_t i = 0; i < count; ++i) {
+        size_t L = words[i] ? word_len_if_valid(words[i]) : 0;
+        if (L) ++wi->len[L].count;
+    }
+    for (size_t L = 1; L < MAX_WORD_LEN; ++L) {
+        WordIndexBucket *b = &wi->len[L];
+        if (!b->count) continue;
+        b->nblocks = (b->count + 63) / 64;
+        b->ids = (size_t*)malloc(b->count * sizeof(size_t));
+        b->bits = (uint64_t*)calloc(L * 26 * b->nblocks, sizeof(uint64_t));
+        if (!b->ids || !b->bits) { wi_free(wi); return false; }
+        b->count = 0;           /* refilled below */
+    }
+    for (size_t i = 0; i < count; ++i) {
+        size_t L = words[i] ? word_len_if_valid(words[i]) : 0;
+        if (bit_of) bit_of[i] = L ? wi->len[L].count : SIZE_MAX;
+        if (!L) continue;
+        WordIndexBucket *b = &wi->len[L];
+        size_t bit = b->count++;
+        b->ids[bit] = i;
+        for (size_t p = 0; p < L; ++p) {
+            size_t letter = (size_t)(words[i][p] - 'A');
+            b->bits[(p * 26 + letter) * b->nblocks + bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+    }
+    return true;
+}
+
+void wi_free(WordIndex *wi) {
+    for (size_t L = 0; L < MAX_WORD_LEN; ++L) {
+        free(wi->len[L].ids);
+        free(wi->len[L].bits);
+    }
+    memset(wi, 0, sizeof *wi);
+}
+
+const WordIndexBucket *wi_bucket(const WordIndex *wi, size_t len) {
+    return len < MAX_WORD_LEN ? &wi->len[len] : NULL;
+}
+
+/* Resolve the fixed letters of pattern to their bitset rows. Returns the
+   bucket, or NULL if nothing can match. */
+static const WordIndexBucket *resolve(const WordIndex *wi, const char *pattern,
+                                      const uint64_t *rows[MAX_WORD_LEN], size_t *nrows)
+{
+    size_t L = strlen(pattern);
+    if (L == 0 || L >= MAX_WORD_LEN || wi->len[L].count == 0) return NULL;
+    const WordIndexBucket *b = &wi->len[L];
+    *nrows = 0;
+    for (size_t p = 0; p < L; ++p) {
+        char ch = pattern[p];
+        if (ch == WI_WILDCARD || ch == '.') continue;
+        if (ch >= 'a' && ch <= 'z') ch = (char)(ch - 'a' + 'A');
+        if (ch < 'A' || ch > 'Z') return NULL;
+        rows[(*nrows)++] = b->bits + (p * 26 + (size_t)(ch - 'A')) * b->nblocks;
+    }
+    return b;
+}
+
+static size_t intersect(const WordIndexBucket *b, const uint64_t *const *rows, size_t nrows,
+                        const uint64_t *exclude, uint64_t *out)
+{
+    size_t total = 0;
+    uint64_t tail = b->count % 64 ? ((uint64_t)1 << (b->count % 64)) - 1 : ~(uint64_t)0;
+    for (size_t k = 0; k < b->nblocks; ++k) {
+        uint64_t acc = k + 1 == b->nblocks ? tail : ~(uint64_t)0;
+        for (size_t r = 0; r < nrows && acc; ++r) acc &= rows[r][k];
+        if (exclude) acc &= ~exclude[k];
+        if (out) out[k] = acc;
+        total += popcount64(acc);
+    }
+    return total;
+}
+
+size_t wi_count(const WordIndex *wi, const char *pattern, const uint64_t *exclude) {
+    const uint64_t *rows[MAX_WORD_LEN];
+    size_t nrows;
+    const WordIndexBucket *b = resolve(wi, pattern, rows, &nrows);
+    return b ? intersect(b, rows, nrows, exclude, NULL) : 0;
+}
+
+size_t wi_query(const WordIndex *wi, const char *pattern, const uint64_t *exclude, uint64_t *out) {
+    const uint64_t *rows[MAX_WORD_LEN];
+    size_t nrows;
+    const WordIndexBucket *b = resolve(wi, pattern, rows, &nrows);
+    if (!b) {
+        size_t L = strlen(pattern);
+        if (L < MAX_WORD_LEN && wi->len[L].nblocks)
+            memset(out, 0, wi->len[L].nblocks * sizeof(uint64_t));
+        return 0;
+    }
+    return intersect(b, rows, nrows, exclude, out);
+}
@@ -0,0 +1,41 @@
+#ifndef WORDINDEX_H
+#define WORDINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "crossword.h"
+
+/* Positional dictionary index. For every word length there is one bitset
+   per (position, letter) marking the words with that letter there, so a
+   pattern such as "C?D?" is answered by AND-ing two bitsets a 64-bit
+   word at a time and counting bits. */
+
+#define WI_WILDCARD '?'
+
+typedef struct {
+    size_t    count;        /* words of this length */
+    size_t    nblocks;      /* uint64_t blocks per bitset */
+    size_t   *ids;          /* bit i -> caller's word id */
+    uint64_t *bits;         /* [(pos * 26 + letter) * nblocks + block] */
+} WordIndexBucket;
+
+typedef struct {
+    WordIndexBucket len[MAX_WORD_LEN];
+} WordIndex;
+
+/* Index uppercase A-Z words (anything else is skipped). If bit_of is not
+   NULL it receives, per input word, its bit within its length bucket
+   (SIZE_MAX for skipped words). */
+bool wi_build(WordIndex *wi, const char *const *words, size_t count, size_t *bit_of);
+void wi_free(WordIndex *wi);
+
+const WordIndexBucket *wi_bucket(const WordIndex *wi, size_t len);
+
+/* Words matching pattern ('?' or '.' = any letter). exclude may be NULL or
+   a bucket-sized bitset of words to leave out. wi_query also writes the
+   matching bitset to out (bucket nblocks long). Both return the count. */
+size_t wi_count(const WordIndex *wi, const char *pattern, const uint64_t *exclude);
+size_t wi_query(const WordIndex *wi, const char *pattern, const uint64_t *exclude, uint64_t *out);
+
+#endif
@@ -0,0 +1,249 @@
+#include "wordlist.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WL_SSE2 1
+#endif
+
+#define WL_CHUNK (1u << 20)         /* read size */
+
+void wl_init(WordList *wl) {
+    memset(wl, 0, sizeof *wl);
+}
+
+void wl_free(WordList *wl) {
+    free(wl->pool);
+    free(wl->offset);
+    free(wl->slots);
+    wl_init(wl);
+}
+
+/* ---------------- Normalization ---------------- */
+
+static bool upcase_scalar(char *s, size_t n) {
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 'a' && c <= 'z') c = (unsigned char)(c - 32);
+        s[i] = (char)c;
+        ok &= c >= 'A' && c <= 'Z';
+    }
+    return ok;
+}
+
+bool wl_upcase_letters(char *s, size_t n) {
+    size_t i = 0;
+    bool ok = true;
+#ifdef WL_SSE2
+    /* signed byte compares: bytes >= 0x80 are negative and fall outside
+       both ranges, so they are left alone and reported invalid */
+    const __m128i lo_a = _mm_set1_epi8('a' - 1), hi_z = _mm_set1_epi8('z' + 1);
+    const __m128i lo_A = _mm_set1_epi8('A' - 1), hi_Z = _mm_set1_epi8('Z' + 1);
+    const __m128i bit5 = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, lo_a), _mm_cmplt_epi8(v, hi_z));
+        v = _mm_sub_epi8(v, _mm_and_si128(lower, bit5));
+        _mm_storeu_si128((__m128i*)(s + i), v);
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, lo_A), _mm_cmplt_epi8(v, hi_Z));
+        ok &= _mm_movemask_epi8(upper) == 0xFFFF;
+    }
+#endif
+    return upcase_scalar(s + i, n - i) && ok;
+}
+
+/* ---------------- Hash set ---------------- */
+
+static uint64_t hash_bytes(const char *s, size_t n) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t k;
+        memcpy(&k, s + i, 8);
+        h = (h ^ k) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    uint64_t k = 0;
+    memcpy(&k, s + i, n - i);
+    h ^= k;
+    /* full avalanche: the table index uses the low bits, the tag the high */
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+typedef struct WordListSlot Slot;
+
+static bool set_grow(WordList *wl) {
+    size_t cap = wl->slot_cap ? wl->slot_cap * 2 : 1024;
+    Slot *t = (Slot*)calloc(cap, sizeof(Slot));
+    if (!t) return false;
+    for (size_t i = 0; i < wl->slot_cap; ++i) {
+        if (!wl->slots[i].pos) continue;
+        size_t j = (size_t)wl->slots[i].hash & (cap - 1);
+        while (t[j].pos) j = (j + 1) & (cap - 1);
+        t[j] = wl->slots[i];
+    }
+    free(wl->slots);
+    wl->slots = t;
+    wl->slot_cap = cap;
+    return true;
+}
+
+/* ---------------- Adding words ---------------- */
+
+static bool reserve(WordList *wl, size_t len) {
+    if (wl->count == wl->cap) {
+        size_t cap = wl->cap ? wl->cap * 2 : 1024;
+        size_t *o = (size_t*)realloc(wl->offset, cap * sizeof(size_t));
+        if (!o) return false;
+        wl->offset = o;
+        wl->cap = cap;
+    }
+    if (wl->pool_len + len + 1 > wl->pool_cap) {
+        size_t cap = wl->pool_cap ? wl->pool_cap : 1u << 16;
+        while (cap < wl->pool_len + len + 1) cap *= 2;
+        char *p = (char*)realloc(wl->pool, cap);
+        if (!p) return false;
+        wl->pool = p;
+        wl->pool_cap = cap;
+    }
+    if ((wl->count + 1) * 2 > wl->slot_cap && !set_grow(wl)) return false;
+    return true;
+}
+
+/* w is already normalized; inserts unless present */
+static bool insert_normalized(WordList *wl, const char *w, size_t len, WordListStats *st) {
+    if (!reserve(wl, len)) { wl->failed = true; return false; }
+    uint64_t h = hash_bytes(w, len);
+    size_t j = (size_t)h & (wl->slot_cap - 1);
+    while (wl->slots[j].pos) {
+        if (wl->slots[j].hash == h) {
+            const char *other = wl->pool + wl->slots[j].pos - 1;
+            if (memcmp(other, w, len) == 0 && other[len] == '\0') {
+                if (st) ++st->duplicates;
+                return false;
+            }
+        }
+        j = (j + 1) & (wl->slot_cap - 1);
+    }
+    memcpy(wl->pool + wl->pool_len, w, len);
+    wl->pool[wl->pool_len + len] = '\0';
+    wl->offset[wl->count] = wl->pool_len;
+    wl->pool_len += len + 1;
+    wl->slots[j].hash = h;
+    wl->slots[j].pos = wl->offset[wl->count] + 1;
+    ++wl->count;
+    if (st) ++st->accepted;
+    return true;
+}
+
+/* s is writable and normalized in place */
+static bool add_line(WordList *wl, char *s, size_t len, size_t max_len, WordListStats *st) {
+    if (len && s[len - 1] == '\r') --len;
+    if (len == 0) return false;
+    if (st) ++st->lines;
+    if (len > max_len) { if (st) ++st->too_long; return false; }
+    if (!wl_upcase_letters(s, len)) { if (st) ++st->invalid; return false; }
+    return insert_normalized(wl, s, len, st);
+}
+
+bool wl_add(WordList *wl, const char *word, size_t len, size_t max_len, WordListStats *st) {
+    char buf[256];
+    if (len > max_len || len >= sizeof buf) {
+        if (st) { ++st->lines; ++st->too_long; }
+        return false;
+    }
+    memcpy(buf, word, len);
+    return add_line(wl, buf, len, max_len, st);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    if (timespec_get(&ts, TIME_UTC) != TIME_UTC) return 0.0;
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+bool wl_load_stream(WordList *wl, FILE *f, size_t max_len, WordListStats *st) {
+    char *buf = (char*)malloc(WL_CHUNK + 1);
+    if (!buf) return false;
+    double t0 = now_seconds();
+    size_t have = 0;                /* carried-over partial line */
+    bool ok = true;
+    for (;;) {
+        size_t got = fread(buf + have, 1, WL_CHUNK - have, f);
+        if (st) st->bytes += got;
+        size_t end = have + got;
+        bool eof = got == 0;
+        char *p = buf, *stop = buf + end;
+        for (;;) {
+            char *nl = (char*)memchr(p, '\n', (size_t)(stop - p));
+            if (!nl) break;
+            add_line(wl, p, (size_t)(nl - p), max_len, st);
+            p = nl + 1;
+        }
+        have = (size_t)(stop - p);
+        if (eof) {
+            if (have) add_line(wl, p, have, max_len, st);
+            break;
+        }
+        if (have == WL_CHUNK) {
+            /* a single line filled the buffer: far over any max_len, skip it */
+            if (st) { ++st->lines; ++st->too_long; }
+            int c;
+            while ((c = fgetc(f)) != EOF && c != '\n') if (st) ++st->bytes;
+            if (c == '\n' && st) ++st->bytes;
+            have = 0;
+            continue;
+        }
+        memmove(buf, p, have);
+    }
+    if (ferror(f) || wl->failed) ok = false;
+    if (st) st->seconds += now_seconds() - t0;
+    free(buf);
+    return ok;
+}
+
+/* size the hash set for about one word per 8 bytes of input up front,
+   so a large list is not rehashed over and over while loading */
+static void presize(WordList *wl, long bytes) {
+    size_t want = (size_t)bytes / 8 * 2;
+    if (want <= wl->slot_cap || want > ((size_t)1 << 30)) return;
+    size_t cap = wl->slot_cap ? wl->slot_cap : 1024;
+    while (cap < want) cap *= 2;
+    while (wl->slot_cap < cap && set_grow(wl)) {}
+}
+
+bool wl_load_file(WordList *wl, const char *path, size_t max_len, WordListStats *st) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long size = ftell(f);
+        if (size > 0) presize(wl, size);
+        rewind(f);
+    }
+    bool ok = wl_load_stream(wl, f, max_len, st);
+    fclose(f);
+    return ok;
+}
+
+const char **wl_pointers(const WordList *wl) {
+    const char **v = (const char**)malloc((wl->count ? wl->count : 1) * sizeof(char*));
+    if (!v) return NULL;
+    for (size_t i = 0; i < wl->count; ++i) v[i] = wl_word(wl, i);
+    return v;
+}
+
+double wl_mb_per_sec(const WordListStats *st) {
+    return st->seconds > 0.0 ? (double)st->bytes / 1e6 / st->seconds : 0.0;
+}
+
+void wl_print_stats(const WordListStats *st, FILE *out) {
+    fprintf(out, "Read %zu bytes, %zu lines in %.3fs (%.1f MB/s)\n",
+            st->bytes, st->lines, st->seconds, wl_mb_per_sec(st));
+    fprintf(out, "  accepted=%zu duplicates=%zu too_long=%zu invalid=%zu\n",
+            st->accepted, st->duplicates, st->too_long, st->invalid);
+}
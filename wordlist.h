@@ -0,0 +1,58 @@
+#ifndef WORDLIST_H
+#define WORDLIST_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct WordListSlot {
+    uint64_t hash;          /* full hash: rehashing never touches the pool */
+    size_t   pos;           /* pool offset + 1, 0 = empty */
+};
+
+/* Bulk word-list ingestion: one word per line, read in large chunks,
+   uppercased and checked for A-Z in place (SSE2 when available),
+   de-duplicated through an open-addressing hash set. */
+
+typedef struct {
+    char   *pool;           /* accepted words, each NUL-terminated */
+    size_t  pool_len, pool_cap;
+    size_t *offset;         /* word i = pool + offset[i] */
+    size_t  count, cap;
+    struct WordListSlot *slots;  /* open-addressing hash set over pool */
+    size_t  slot_cap;
+    bool    failed;         /* sticky: an allocation failed */
+} WordList;
+
+typedef struct {
+    size_t lines;           /* non-empty lines seen */
+    size_t accepted;
+    size_t duplicates;
+    size_t too_long;
+    size_t invalid;         /* characters outside A-Z / a-z */
+    size_t bytes;
+    double seconds;
+} WordListStats;
+
+void wl_init(WordList *wl);
+void wl_free(WordList *wl);
+
+/* add one word (any case); false if invalid, too long or a duplicate */
+bool wl_add(WordList *wl, const char *word, size_t len, size_t max_len, WordListStats *st);
+
+/* append every line of a file/stream; stats are accumulated into st (may be NULL) */
+bool wl_load_stream(WordList *wl, FILE *f, size_t max_len, WordListStats *st);
+bool wl_load_file(WordList *wl, const char *path, size_t max_len, WordListStats *st);
+
+static inline const char *wl_word(const WordList *wl, size_t i) { return wl->pool + wl->offset[i]; }
+/* malloc'd array of count word pointers (for dawg_build / wi_build) */
+const char **wl_pointers(const WordList *wl);
+
+/* uppercase s[0..n) in place; true if every byte is then 'A'..'Z' */
+bool wl_upcase_letters(char *s, size_t n);
+
+double wl_mb_per_sec(const WordListStats *st);
+void wl_print_stats(const WordListStats *st, FILE *out);
+
+#endif
@@ -0,0 +1,152 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "workpool.h"
+#include <stdlib.h>
+
+/* Threads come from pthreads (also provided by MinGW); build with
+   -DWORKPOOL_NO_THREADS where they are unavailable. */
+#if defined(_MSC_VER) && !defined(WORKPOOL_NO_THREADS)
+#define WORKPOOL_NO_THREADS
+#endif
+
+#ifndef WORKPOOL_NO_THREADS
+#include <pthread.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+unsigned workpool_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors ? (unsigned)si.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+#else
+    return 1;
+#endif
+}
+
+static void run_inline(size_t ntasks, WorkFn fn, void *arg) {
+    for (size_t t = 0; t < ntasks; ++t) fn(arg, t, 0);
+}
+
+#ifdef WORKPOOL_NO_THREADS
+
+bool workpool_run(unsigned threads, size_t ntasks, WorkFn fn, void *arg) {
+    (void)threads;
+    run_inline(ntasks, fn, arg);
+    return false;
+}
+
+#else
+
+/* tasks[head..tail) still waiting in this worker's deque */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t *tasks;
+    size_t head, tail;
+} Deque;
+
+typedef struct {
+    Deque   *deques;
+    unsigned nworkers;
+    WorkFn   fn;
+    void    *arg;
+} Pool;
+
+typedef struct {
+    Pool    *pool;
+    unsigned id;
+} Worker;
+
+static bool take_front(Deque *d, size_t *task) {
+    pthread_mutex_lock(&d->lock);
+    bool ok = d->head < d->tail;
+    if (ok) *task = d->tasks[d->head++];
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static bool steal_back(Deque *d, size_t *task) {
+    pthread_mutex_lock(&d->lock);
+    bool ok = d->head < d->tail;
+    if (ok) *task = d->tasks[--d->tail];
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static void *worker_main(void *p) {
+    Worker *w = (Worker*)p;
+    Pool *pool = w->pool;
+    size_t task;
+    for (;;) {
+        if (take_front(&pool->deques[w->id], &task)) {
+            pool->fn(pool->arg, task, w->id);
+            continue;
+        }
+        /* own deque empty: scan the others once, starting after ourselves.
+           Tasks are never added, so a full empty scan means we are done. */
+        bool stole = false;
+        for (unsigned k = 1; k < pool->nworkers && !stole; ++k) {
+            Deque *victim = &pool->deques[(w->id + k) % pool->nworkers];
+            stole = steal_back(victim, &task);
+        }
+        if (!stole) break;
+        pool->fn(pool->arg, task, w->id);
+    }
+    return NULL;
+}
+
+bool workpool_run(unsigned threads, size_t ntasks, WorkFn fn, void *arg) {
+    if (threads == 0) threads = 1;
+    if (threads > ntasks) threads = ntasks ? (unsigned)ntasks : 1;
+    if (threads == 1) { run_inline(ntasks, fn, arg); return true; }
+
+    Pool pool = { NULL, threads, fn, arg };
+    size_t *slots = (size_t*)malloc(ntasks * sizeof(size_t));
+    pool.deques = (Deque*)calloc(threads, sizeof(Deque));
+    Worker *workers = (Worker*)malloc(threads * sizeof(Worker));
+    pthread_t *tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if (!slots || !pool.deques || !workers || !tids) {
+        free(slots); free(pool.deques); free(workers); free(tids);
+        run_inline(ntasks, fn, arg);
+        return false;
+    }
+
+    /* round-robin: worker w gets w, w+T, w+2T, ... stored contiguously */
+    size_t pos = 0;
+    for (unsigned w = 0; w < threads; ++w) {
+        Deque *d = &pool.deques[w];
+        pthread_mutex_init(&d->lock, NULL);
+        d->tasks = slots + pos;
+        d->head = d->tail = 0;
+        for (size_t t = w; t < ntasks; t += threads) d->tasks[d->tail++] = t;
+        pos += d->tail;
+    }
+
+    unsigned started = 0;
+    for (; started < threads; ++started) {
+        workers[started].pool = &pool;
+        workers[started].id = started;
+        if (pthread_create(&tids[started], NULL, worker_main, &workers[started]) != 0) break;
+    }
+    /* whatever could not be started is drained by the remaining workers;
+       with none at all, the caller does the work */
+    if (started == 0) {
+        Worker self = { &pool, 0 };
+        worker_main(&self);
+    }
+    for (unsigned i = 0; i < started; ++i) pthread_join(tids[i], NULL);
+
+    for (unsigned w = 0; w < threads; ++w) pthread_mutex_destroy(&pool.deques[w].lock);
+    free(slots); free(pool.deques); free(workers); free(tids);
+    return started > 0;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Runs fn(arg, task, worker) for task = 0..ntasks-1 on `threads` workers.
+   Each worker owns a deque seeded round-robin (so low task ids start
+   first); it takes work from the front of its own deque and, when that
+   runs dry, steals from the back of another worker's. Returns false if
+   the workers could not be started (the tasks then run on the caller). */
+typedef void (*WorkFn)(void *arg, size_t task, unsigned worker);
+
+bool workpool_run(unsigned threads, size_t ntasks, WorkFn fn, void *arg);
+
+/* number of online CPUs, at least 1 */
+unsigned workpool_cpu_count(void);
+
+#endif